@@ -0,0 +1,18 @@
+#!/bin/bash
+# builds the scaling benchmark of Module_1 and runs it with the given options
+# (see ./build/Module_1/benchmark.out -h)
+mkdir -p build
+mkdir -p build/Module_1
+bash ./buildRuntime.sh
+g++ -c -o ./build/Module_1/LL1.out ./src/Module_1/LL1.cpp
+g++ -c -o ./build/Module_1/CompileStats.out ./src/Module_1/CompileStats.cpp
+g++ -c -o ./build/Module_1/GrammarReader.out ./src/Module_1/GrammarReader.cpp
+g++ -c -o ./build/Module_1/LookaheadTrie.out ./src/Module_1/LookaheadTrie.cpp
+g++ -c -o ./build/Module_1/PluginWriter.out ./src/Module_1/PluginWriter.cpp
+g++ -c -o ./build/Module_1/RuleArena.out ./src/Module_1/RuleArena.cpp
+g++ -c -o ./build/Module_1/RuleTable.out ./src/Module_1/RuleTable.cpp
+g++ -c -o ./build/Module_1/SyntheticGrammar.out ./src/Module_1/SyntheticGrammar.cpp
+g++ -c -o ./build/Module_1/ThreadPool.out ./src/Module_1/ThreadPool.cpp
+g++ -c -o ./build/Module_1/benchmarkTmp.out ./src/Module_1/benchmark.cpp
+g++ -pthread -o ./build/Module_1/benchmark.out ./build/Module_1/LL1.out ./build/Module_1/CompileStats.out ./build/Module_1/GrammarReader.out ./build/Module_1/LookaheadTrie.out ./build/Module_1/PluginWriter.out ./build/Module_1/RuleArena.out ./build/Module_1/RuleTable.out ./build/Module_1/SyntheticGrammar.out ./build/Module_1/ThreadPool.out ./build/Module_1/benchmarkTmp.out ./build/Common/libLL1Runtime.a
+./build/Module_1/benchmark.out "$@"
@@ -1,6 +1,16 @@
 #!/bin/bash
 mkdir -p build
 mkdir -p build/Module_1
+bash ./buildRuntime.sh
 g++ -c -o ./build/Module_1/LL1.out ./src/Module_1/LL1.cpp
+g++ -c -o ./build/Module_1/ArtifactCache.out ./src/Module_1/ArtifactCache.cpp
+g++ -c -o ./build/Module_1/CompileStats.out ./src/Module_1/CompileStats.cpp
+g++ -c -o ./build/Module_1/GrammarBatch.out ./src/Module_1/GrammarBatch.cpp
+g++ -c -o ./build/Module_1/GrammarReader.out ./src/Module_1/GrammarReader.cpp
+g++ -c -o ./build/Module_1/LookaheadTrie.out ./src/Module_1/LookaheadTrie.cpp
+g++ -c -o ./build/Module_1/PluginWriter.out ./src/Module_1/PluginWriter.cpp
+g++ -c -o ./build/Module_1/RuleArena.out ./src/Module_1/RuleArena.cpp
+g++ -c -o ./build/Module_1/RuleTable.out ./src/Module_1/RuleTable.cpp
+g++ -c -o ./build/Module_1/ThreadPool.out ./src/Module_1/ThreadPool.cpp
 g++ -c -o ./build/Module_1/mainTmp.out ./src/Module_1/main.cpp
-g++ -o ./build/Module_1/main.out ./build/Module_1/LL1.out ./build/Module_1/mainTmp.out
+g++ -pthread -o ./build/Module_1/main.out ./build/Module_1/LL1.out ./build/Module_1/ArtifactCache.out ./build/Module_1/CompileStats.out ./build/Module_1/GrammarBatch.out ./build/Module_1/GrammarReader.out ./build/Module_1/LookaheadTrie.out ./build/Module_1/PluginWriter.out ./build/Module_1/RuleArena.out ./build/Module_1/RuleTable.out ./build/Module_1/ThreadPool.out ./build/Module_1/mainTmp.out ./build/Common/libLL1Runtime.a
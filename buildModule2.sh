@@ -1,8 +1,16 @@
 #!/bin/bash
 mkdir -p build
 mkdir -p build/Module_2
-flex -o ./src/Module_2/lex.yy.c ./src/Module_2/lex.l
+bash ./buildRuntime.sh
+# lex.yy.c is committed for machines without flex; regenerate it otherwise
+if command -v flex > /dev/null; then
+  flex -o ./src/Module_2/lex.yy.c ./src/Module_2/lex.l
+else
+  echo "flex not found: building the committed ./src/Module_2/lex.yy.c"
+fi
 gcc -c -o ./build/Module_2/lex.out ./src/Module_2/lex.yy.c
-g++ -c -o ./build/Module_2/LL1Parser.out ./src/Module_2/LL1Parser.cpp
+g++ -c -o ./build/Module_2/MappedFile.out ./src/Module_2/MappedFile.cpp
+g++ -c -o ./build/Module_2/Scanner.out ./src/Module_2/Scanner.cpp
+g++ -c -o ./build/Module_2/SimdScanner.out ./src/Module_2/SimdScanner.cpp
 g++ -c -o ./build/Module_2/mainTmp.out ./src/Module_2/main.cpp
-g++ -o ./build/Module_2/main.out ./build/Module_2/LL1Parser.out ./build/Module_2/mainTmp.out ./build/Module_2/lex.out
+g++ -pthread -o ./build/Module_2/main.out ./build/Module_2/mainTmp.out ./build/Module_2/MappedFile.out ./build/Module_2/Scanner.out ./build/Module_2/SimdScanner.out ./build/Module_2/lex.out ./build/Common/libLL1Runtime.a -ldl
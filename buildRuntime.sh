@@ -0,0 +1,13 @@
+#!/bin/bash
+# builds the parser runtime (symbols, rules, the table-driven parser and the
+# loader of grammar plugins) that Module_1 and Module_2 both link
+mkdir -p build
+mkdir -p build/Common
+g++ -c -o ./build/Common/symbolTable.out ./src/Common/symbolTable.cpp
+g++ -c -o ./build/Common/structs.out ./src/Common/structs.cpp
+g++ -c -o ./build/Common/AdaptivePredictor.out ./src/Common/AdaptivePredictor.cpp
+g++ -c -o ./build/Common/LL1Parser.out ./src/Common/LL1Parser.cpp
+g++ -c -o ./build/Common/GrammarPlugin.out ./src/Common/GrammarPlugin.cpp
+g++ -c -o ./build/Common/ParserRegistry.out ./src/Common/ParserRegistry.cpp
+rm -f ./build/Common/libLL1Runtime.a
+ar rcs ./build/Common/libLL1Runtime.a ./build/Common/symbolTable.out ./build/Common/structs.out ./build/Common/AdaptivePredictor.out ./build/Common/LL1Parser.out ./build/Common/GrammarPlugin.out ./build/Common/ParserRegistry.out
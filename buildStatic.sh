@@ -0,0 +1,6 @@
+#!/bin/bash
+# builds the example parser whose grammar is compiled by the C++ compiler
+# (see src/Static/StaticLL1.hpp); needs C++20
+mkdir -p build
+mkdir -p build/Static
+g++ -std=c++20 -o ./build/Static/expression.out ./src/Static/expression.cpp
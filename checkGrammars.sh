@@ -0,0 +1,20 @@
+#!/bin/bash
+# compiles the grammar of every grammar directory with each set of flags
+# below and fails if any of them is not LL(1) (the committed files are not
+# touched)
+bash ./buildModule1.sh
+outputDir=$(mktemp -d)
+trap 'rm -rf "$outputDir"' EXIT
+status=0
+for grammarDir in ./grammar_*/; do
+  for flags in "" "-x"; do
+    if ! ./build/Module_1/main.out -f $flags -g "$grammarDir/Grammar.txt" \
+        -o "$outputDir" > "$outputDir/log.txt"; then
+      echo "FAILED: $grammarDir with flags '$flags'"
+      tail -5 "$outputDir/log.txt"
+      status=1
+    fi
+  done
+done
+[ $status -eq 0 ] && echo "All grammars compile"
+exit $status
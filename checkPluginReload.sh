@@ -0,0 +1,15 @@
+#!/bin/bash
+# builds the plugins of grammar_1 and grammar_2, then checks that each new
+# build renamed over a loaded plugin is loaded in its place
+# (see src/Common/checkPluginReload.cpp)
+bash ./buildModule1.sh
+g++ -c -o ./build/Common/checkPluginReloadTmp.out ./src/Common/checkPluginReload.cpp
+g++ -o ./build/Common/checkPluginReload.out ./build/Common/checkPluginReloadTmp.out ./build/Common/libLL1Runtime.a -ldl
+pluginDir=$(mktemp -d)
+trap 'rm -rf "$pluginDir"' EXIT
+./build/Module_1/main.out -g ./grammar_1/Grammar.txt -P "$pluginDir/grammar_1.so" || exit 1
+./build/Module_1/main.out -g ./grammar_2/Grammar.txt -P "$pluginDir/grammar_2.so" || exit 1
+./build/Common/checkPluginReload.out "$pluginDir/plugin.so" \
+  "$pluginDir/grammar_1.so" "id + id" \
+  "$pluginDir/grammar_2.so" "prog int id ; end" \
+  "$pluginDir/grammar_1.so" "id * ( id )"
@@ -0,0 +1,19 @@
+#!/bin/bash
+# builds the differential check of Module_2's SIMD scanner against the flex
+# scanner and runs it with the given options and files
+# (see ./build/Module_2/compareScanners.out -h)
+mkdir -p build
+mkdir -p build/Module_2
+# lex.yy.c is committed for machines without flex; regenerate it otherwise
+if command -v flex > /dev/null; then
+  flex -o ./src/Module_2/lex.yy.c ./src/Module_2/lex.l
+else
+  echo "flex not found: building the committed ./src/Module_2/lex.yy.c"
+fi
+gcc -c -o ./build/Module_2/lex.out ./src/Module_2/lex.yy.c
+g++ -c -o ./build/Module_2/MappedFile.out ./src/Module_2/MappedFile.cpp
+g++ -c -o ./build/Module_2/Scanner.out ./src/Module_2/Scanner.cpp
+g++ -c -o ./build/Module_2/SimdScanner.out ./src/Module_2/SimdScanner.cpp
+g++ -c -o ./build/Module_2/compareScannersTmp.out ./src/Module_2/compareScanners.cpp
+g++ -o ./build/Module_2/compareScanners.out ./build/Module_2/compareScannersTmp.out ./build/Module_2/MappedFile.out ./build/Module_2/Scanner.out ./build/Module_2/SimdScanner.out ./build/Module_2/lex.out
+./build/Module_2/compareScanners.out "$@"
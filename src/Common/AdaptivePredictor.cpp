@@ -0,0 +1,267 @@
+#include "AdaptivePredictor.hpp"
+
+#include <algorithm>
+#include <mutex>
+#include <set>
+
+// Stacks never grow past this while simulating. Only a grammar with hidden
+// left recursion (A -> B A ..., B nullable) gets there, and it would
+// otherwise expand forever.
+static const int MAX_STACK_SIZE = 1 << 12;
+
+static int idOf(const Symbol* sym) { return (sym != nullptr) ? sym->id : -1; }
+
+bool AdaptivePredictor::Config::operator<(const Config& other) const {
+  if (this->alt != other.alt) return this->alt < other.alt;
+  if (this->ctx != other.ctx) return idOf(this->ctx) < idOf(other.ctx);
+  return lexicographical_compare(
+      this->stack.begin(), this->stack.end(), other.stack.begin(),
+      other.stack.end(),
+      [](const Symbol* a, const Symbol* b) { return a->id < b->id; });
+}
+
+bool AdaptivePredictor::Config::operator==(const Config& other) const {
+  return this->alt == other.alt && this->ctx == other.ctx &&
+         this->stack == other.stack;
+}
+
+AdaptivePredictor::AdaptivePredictor(Symbol* startSymbol, Symbol* dollarSymbol,
+                                     Symbol* epsSymbol,
+                                     const SymbolTable* symbolTable) {
+  this->startSymbol = startSymbol;
+  this->dollarSymbol = dollarSymbol;
+  this->epsSymbol = epsSymbol;
+  this->symbolTable = symbolTable;
+}
+
+void AdaptivePredictor::addRule(ProductionRule* pr) {
+  this->rules[pr->lhs].push_back(pr);
+  for (int i = 0; i < (int)pr->rhs.size(); ++i) {
+    if (!pr->rhs[i]->isTerminal) this->uses[pr->rhs[i]].push_back({pr, i});
+  }
+}
+
+void AdaptivePredictor::pushRhs(const ProductionRule* pr, int from,
+                                vector<Symbol*>& stack) const {
+  for (int i = (int)pr->rhs.size() - 1; i >= from; --i) {
+    if (pr->rhs[i] != this->epsSymbol) stack.push_back(pr->rhs[i]);
+  }
+}
+
+void AdaptivePredictor::closure(vector<Config>& configs) const {
+  set<Config> seen;
+  vector<Config> worklist;
+  worklist.swap(configs);
+  while (!worklist.empty()) {
+    Config config = move(worklist.back());
+    worklist.pop_back();
+    if (!seen.insert(config).second) continue;
+
+    if (config.stack.empty()) {
+      // the whole input is matched
+      if (config.ctx == nullptr) {
+        configs.push_back(move(config));
+        continue;
+      }
+      // the rule of ctx is done: go on after every use of ctx
+      if (config.ctx == this->startSymbol) {
+        worklist.push_back({config.alt, {this->dollarSymbol}, nullptr});
+      }
+      auto ctxUses = this->uses.find(config.ctx);
+      if (ctxUses == this->uses.end()) continue;
+      for (const auto& use : ctxUses->second) {
+        Config next{config.alt, {}, use.first->lhs};
+        this->pushRhs(use.first, use.second + 1, next.stack);
+        worklist.push_back(move(next));
+      }
+      continue;
+    }
+
+    Symbol* top = config.stack.back();
+    if (top->isTerminal) {
+      configs.push_back(move(config));
+      continue;
+    }
+    if ((int)config.stack.size() >= MAX_STACK_SIZE) continue;
+    auto topRules = this->rules.find(top);
+    if (topRules == this->rules.end()) continue;
+    config.stack.pop_back();
+    for (const ProductionRule* pr : topRules->second) {
+      Config next = config;
+      this->pushRhs(pr, 0, next.stack);
+      worklist.push_back(move(next));
+    }
+  }
+  sort(configs.begin(), configs.end());
+  configs.erase(unique(configs.begin(), configs.end()), configs.end());
+}
+
+vector<AdaptivePredictor::Config> AdaptivePredictor::advance(
+    const vector<Config>& configs, Symbol* token) const {
+  vector<Config> reach;
+  for (const Config& config : configs) {
+    if (!config.stack.empty() && config.stack.back() == token) {
+      reach.push_back(config);
+      reach.back().stack.pop_back();
+    }
+  }
+  return reach;
+}
+
+int AdaptivePredictor::uniqueAlt(const vector<Config>& configs) {
+  if (configs.empty()) return -1;
+  // configs are sorted by alt first
+  return (configs.front().alt == configs.back().alt) ? configs.front().alt
+                                                     : -1;
+}
+
+int AdaptivePredictor::minAlt(const vector<Config>& configs) {
+  return configs.front().alt;
+}
+
+bool AdaptivePredictor::allStacksConflict(const vector<Config>& configs,
+                                          bool& sameAlts) {
+  // rules reaching each (stack, ctx), keyed by the config with alt 0
+  map<Config, vector<int>> altsOf;
+  for (const Config& config : configs) {
+    Config key{0, config.stack, config.ctx};
+    altsOf[key].push_back(config.alt);
+  }
+  sameAlts = true;
+  const vector<int>& firstAlts = altsOf.begin()->second;
+  for (const auto& entry : altsOf) {
+    if (entry.second.size() < 2) return false;
+    sameAlts &= (entry.second == firstAlts);
+  }
+  return true;
+}
+
+AdaptivePredictor::DFAState* AdaptivePredictor::addState(
+    DecisionDFA& dfa, vector<Config>& configs) const {
+  unique_ptr<DFAState>& state = dfa.states[configs];
+  if (state != nullptr) return state.get();
+  state.reset(new DFAState());
+  state->configs = configs;
+  state->predictedAlt = -1;
+  state->needsFullContext = false;
+
+  // a finished config has matched $, i.e. all the input: only those count
+  vector<Config> finished;
+  for (const Config& config : configs) {
+    if (config.stack.empty() && config.ctx == nullptr) {
+      finished.push_back(config);
+    }
+  }
+  const vector<Config>& live = finished.empty() ? configs : finished;
+  state->predictedAlt = uniqueAlt(live);
+  bool sameAlts;
+  state->needsFullContext = state->predictedAlt < 0 && !live.empty() &&
+                            (!finished.empty() ||
+                             allStacksConflict(live, sameAlts));
+  return state.get();
+}
+
+AdaptivePredictor::DecisionDFA& AdaptivePredictor::dfaOf(
+    Symbol* nonTer) const {
+  {
+    shared_lock<shared_mutex> lock(this->dfaMutex);
+    auto dfa = this->dfas.find(nonTer);
+    if (dfa != this->dfas.end()) return dfa->second;
+  }
+  vector<Config> configs;
+  const vector<ProductionRule*>& alts = this->rules.at(nonTer);
+  for (int alt = 0; alt < (int)alts.size(); ++alt) {
+    Config config{alt, {}, nonTer};
+    this->pushRhs(alts[alt], 0, config.stack);
+    configs.push_back(move(config));
+  }
+  this->closure(configs);
+
+  unique_lock<shared_mutex> lock(this->dfaMutex);
+  auto inserted = this->dfas.insert({nonTer, DecisionDFA()});
+  DecisionDFA& dfa = inserted.first->second;
+  // another parse may have built it meanwhile
+  if (inserted.second) dfa.start = this->addState(dfa, configs);
+  return dfa;
+}
+
+Symbol* AdaptivePredictor::tokenAt(const vector<string>& tokens,
+                                   int index) const {
+  if (index >= (int)tokens.size()) return this->dollarSymbol;
+  Symbol* sym = this->symbolTable->find(tokens[index]);
+  return (sym != nullptr && sym->isTerminal) ? sym : nullptr;
+}
+
+ProductionRule* AdaptivePredictor::predict(Symbol* nonTer,
+                                           const stack<Symbol*>& parserStack,
+                                           const vector<string>& tokens,
+                                           int tokenIndex) const {
+  auto alts = this->rules.find(nonTer);
+  if (alts == this->rules.end()) return nullptr;
+  DecisionDFA& dfa = this->dfaOf(nonTer);
+
+  // states never change once added, only their edges do
+  DFAState* state = dfa.start;
+  for (int i = tokenIndex; !state->needsFullContext; ++i) {
+    if (state->predictedAlt >= 0) return alts->second[state->predictedAlt];
+    if (state->configs.empty()) return nullptr;
+    Symbol* token = this->tokenAt(tokens, i);
+    if (token == nullptr) return nullptr;
+
+    DFAState* next = nullptr;
+    {
+      shared_lock<shared_mutex> lock(this->dfaMutex);
+      auto edge = state->edges.find(token);
+      if (edge != state->edges.end()) next = edge->second;
+    }
+    if (next == nullptr) {
+      vector<Config> reach = this->advance(state->configs, token);
+      this->closure(reach);
+      unique_lock<shared_mutex> lock(this->dfaMutex);
+      next = this->addState(dfa, reach);
+      state->edges[token] = next;
+    }
+    state = next;
+  }
+
+  int alt = this->predictFullContext(nonTer, parserStack, tokens, tokenIndex);
+  return (alt >= 0) ? alts->second[alt] : nullptr;
+}
+
+int AdaptivePredictor::predictFullContext(Symbol* nonTer,
+                                          const stack<Symbol*>& parserStack,
+                                          const vector<string>& tokens,
+                                          int tokenIndex) const {
+  // the parser's stack, top at the back
+  vector<Symbol*> below;
+  for (stack<Symbol*> st = parserStack; !st.empty(); st.pop()) {
+    below.push_back(st.top());
+  }
+  reverse(below.begin(), below.end());
+
+  vector<Config> configs;
+  const vector<ProductionRule*>& alts = this->rules.at(nonTer);
+  for (int alt = 0; alt < (int)alts.size(); ++alt) {
+    Config config{alt, below, nullptr};
+    this->pushRhs(alts[alt], 0, config.stack);
+    configs.push_back(move(config));
+  }
+  this->closure(configs);
+
+  for (int i = tokenIndex;; ++i) {
+    if (configs.empty()) return -1;
+    int alt = uniqueAlt(configs);
+    if (alt >= 0) return alt;
+    // the input is ambiguous (or all matched; after $ every config is
+    // finished): the first rule wins
+    bool sameAlts;
+    if (configs.front().stack.empty() ||
+        (allStacksConflict(configs, sameAlts) && sameAlts)) {
+      return minAlt(configs);
+    }
+    Symbol* token = this->tokenAt(tokens, i);
+    if (token == nullptr) return -1;
+    configs = this->advance(configs, token);
+    this->closure(configs);
+  }
+}
@@ -0,0 +1,101 @@
+#ifndef __COMMON_ADAPTIVE_PREDICTOR_HPP__
+#define __COMMON_ADAPTIVE_PREDICTOR_HPP__
+
+#include <map>
+#include <memory>
+#include <shared_mutex>
+#include <stack>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "structs.hpp"
+
+using namespace std;
+
+// Picks the production rule for the cells of the parsing table that are left
+// to run time (adaptive LL(*) prediction): the rules of the non-terminal are
+// simulated side by side on the remaining input till only one of them can
+// still match it.
+//
+// The simulation first runs without the parser's stack (once a rule is done,
+// it goes on at every place its lhs is used), so what it learns only depends
+// on the input and is kept as a DFA per non-terminal: states are sets of
+// simulation configs, edges are input symbols. Later predictions mostly just
+// walk the DFA. When that simulation can't tell the rules apart, prediction
+// falls back to simulating on the actual parser stack, which is not cached.
+//
+// The DFAs are shared by every parse using the predictor: walking them takes a
+// shared lock, adding states and edges an exclusive one.
+class AdaptivePredictor {
+  // One way the simulation can still go
+  struct Config {
+    // position of the predicted rule among the rules of the non-terminal
+    int alt;
+    // symbols still to be matched, top at the back
+    vector<Symbol*> stack;
+    // non-terminal whose rule ends with the stack (goes on after its uses);
+    // nullptr -> the stack is all that is left of the parse
+    Symbol* ctx;
+    bool operator<(const Config& other) const;
+    bool operator==(const Config& other) const;
+  };
+  struct DFAState {
+    // sorted, every stack has a terminal on top (or is finished)
+    vector<Config> configs;
+    // >= 0 -> every config predicts this rule
+    int predictedAlt;
+    // the rules can't be told apart without the parser's stack
+    bool needsFullContext;
+    unordered_map<Symbol*, DFAState*> edges;
+  };
+  struct DecisionDFA {
+    DFAState* start;
+    map<vector<Config>, unique_ptr<DFAState>> states;
+  };
+
+  Symbol* startSymbol;
+  Symbol* dollarSymbol;
+  Symbol* epsSymbol;
+  const SymbolTable* symbolTable;
+  // rules of every non-terminal, in the order of the grammar file
+  unordered_map<Symbol*, vector<ProductionRule*>> rules;
+  // uses[B] = (rule, position) of every occurrence of B on a rhs
+  unordered_map<Symbol*, vector<pair<ProductionRule*, int>>> uses;
+
+  mutable shared_mutex dfaMutex;
+  mutable unordered_map<Symbol*, DecisionDFA> dfas;
+
+  // pushes the rhs of pr (without eps) onto stack
+  void pushRhs(const ProductionRule* pr, int from,
+               vector<Symbol*>& stack) const;
+  // expands non-terminals on top of the stacks till a terminal is on top;
+  // leaves configs sorted and without duplicates
+  void closure(vector<Config>& configs) const;
+  // configs which match token, with it popped
+  vector<Config> advance(const vector<Config>& configs, Symbol* token) const;
+  // the only rule predicted by configs, -1 if there is none or more than one
+  static int uniqueAlt(const vector<Config>& configs);
+  // true if every stack is reached by more than one rule; sameAlts is set if
+  // they are all reached by the same rules
+  static bool allStacksConflict(const vector<Config>& configs,
+                                bool& sameAlts);
+  static int minAlt(const vector<Config>& configs);
+  // state of dfa with configs (added if new); needs the exclusive lock
+  DFAState* addState(DecisionDFA& dfa, vector<Config>& configs) const;
+  DecisionDFA& dfaOf(Symbol* nonTer) const;
+  int predictFullContext(Symbol* nonTer, const stack<Symbol*>& parserStack,
+                         const vector<string>& tokens, int tokenIndex) const;
+  Symbol* tokenAt(const vector<string>& tokens, int index) const;
+
+ public:
+  AdaptivePredictor(Symbol* startSymbol, Symbol* dollarSymbol,
+                    Symbol* epsSymbol, const SymbolTable* symbolTable);
+  void addRule(ProductionRule* pr);
+  // rule for nonTer at tokens[tokenIndex] (nonTer has just been popped off
+  // parserStack), nullptr if no rule can match the input
+  ProductionRule* predict(Symbol* nonTer, const stack<Symbol*>& parserStack,
+                          const vector<string>& tokens, int tokenIndex) const;
+};
+
+#endif
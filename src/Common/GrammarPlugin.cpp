@@ -0,0 +1,89 @@
+#include "GrammarPlugin.hpp"
+
+#include <dlfcn.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <fstream>
+
+#include "constants.hpp"
+
+// dlopen returns the object already loaded from a path (even if the file
+// was replaced since), so every plugin is loaded from a copy of its own
+static string copyToUniquePath(const string& path) {
+  const char* tmpDir = getenv("TMPDIR");
+  string copyPath = string(tmpDir != nullptr ? tmpDir : "/tmp") +
+                    "/ll1plugin-XXXXXX";
+  int fd = mkstemp(&copyPath[0]);
+  if (fd < 0) throw path + ": can't copy the plugin to load it";
+  close(fd);
+  ifstream in(path, ios::binary);
+  ofstream out(copyPath, ios::binary);
+  if (in) out << in.rdbuf();
+  out.close();
+  if (!in || !out) {
+    unlink(copyPath.c_str());
+    throw path + ": can't read the plugin";
+  }
+  return copyPath;
+}
+
+GrammarPlugin::GrammarPlugin(const string& path) {
+  string copyPath = copyToUniquePath(path);
+  // RTLD_LOCAL: every plugin has the same symbol names
+  this->handle = dlopen(copyPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+  // the mapping outlives the name
+  unlink(copyPath.c_str());
+  if (this->handle == nullptr) throw path + ": " + dlerror();
+  try {
+    auto abiVersion = (PluginAbiVersionFn)this->symbol("ll1PluginAbiVersion");
+    if (abiVersion() != GRAMMAR_PLUGIN_ABI_VERSION) {
+      throw path + ": plugin ABI version " + to_string(abiVersion()) +
+          ", expected " + to_string(GRAMMAR_PLUGIN_ABI_VERSION);
+    }
+    this->generator = ((PluginStringFn)this->symbol("ll1PluginGenerator"))();
+    this->grammarHash =
+        ((PluginStringFn)this->symbol("ll1PluginGrammarHash"))();
+    auto numSymbols = (PluginNumSymbolsFn)this->symbol("ll1PluginNumSymbols");
+    auto symbolName = (PluginSymbolNameFn)this->symbol("ll1PluginSymbolName");
+    auto isTerminal = (PluginIsTerminalFn)this->symbol("ll1PluginIsTerminal");
+    this->parseFn = (PluginParseFn)this->symbol("ll1PluginParse");
+    for (int id = 0; id < numSymbols(); ++id) {
+      string name = symbolName(id);
+      if (!isTerminal(id) || name == EPSILON_SYMBOL || name == DOLLAR_SYMBOL) {
+        continue;
+      }
+      this->terminalIds[name] = id;
+    }
+  } catch (const string&) {
+    dlclose(this->handle);
+    throw;
+  }
+}
+
+GrammarPlugin::~GrammarPlugin() { dlclose(this->handle); }
+
+void* GrammarPlugin::symbol(const char* name) const {
+  void* address = dlsym(this->handle, name);
+  if (address == nullptr) {
+    throw "not a grammar plugin: no " + string(name);
+  }
+  return address;
+}
+
+const string& GrammarPlugin::getGenerator() const { return this->generator; }
+
+const string& GrammarPlugin::getGrammarHash() const {
+  return this->grammarHash;
+}
+
+bool GrammarPlugin::predictiveParsing(const vector<string>& tokens) const {
+  vector<int> ids;
+  for (int i = 0; i < (int)tokens.size(); ++i) {
+    if (i + 1 == (int)tokens.size() && tokens[i] == DOLLAR_SYMBOL) break;
+    auto it = this->terminalIds.find(tokens[i]);
+    if (it == this->terminalIds.end()) return false;
+    ids.push_back(it->second);
+  }
+  return this->parseFn(ids.data(), ids.size()) == 1;
+}
@@ -0,0 +1,64 @@
+#ifndef __COMMON_GRAMMAR_PLUGIN_HPP__
+#define __COMMON_GRAMMAR_PLUGIN_HPP__
+
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+using namespace std;
+
+// C ABI of a grammar plugin: a shared object with a parser specialized for
+// one compiled grammar (written by Module_1 -P, see PluginWriter.hpp). It
+// exports, with C linkage:
+//
+//    unsigned ll1PluginAbiVersion(void);     GRAMMAR_PLUGIN_ABI_VERSION
+//    const char* ll1PluginGenerator(void);   GENERATOR_VERSION
+//    const char* ll1PluginGrammarHash(void); hash of the grammar
+//    int ll1PluginNumSymbols(void);
+//    const char* ll1PluginSymbolName(int id);
+//    int ll1PluginIsTerminal(int id);        1 for terminals, ε and $
+//    int ll1PluginParse(const int* tokens, int numTokens);
+//
+// ll1PluginParse takes the ids of the input terminals (without the final $)
+// and returns 1 if it is accepted, 0 if not. A plugin doesn't depend on
+// anything else of this project, so a new grammar can be loaded into a
+// running process.
+const unsigned GRAMMAR_PLUGIN_ABI_VERSION = 1;
+
+extern "C" {
+typedef unsigned (*PluginAbiVersionFn)(void);
+typedef const char* (*PluginStringFn)(void);
+typedef int (*PluginNumSymbolsFn)(void);
+typedef const char* (*PluginSymbolNameFn)(int);
+typedef int (*PluginIsTerminalFn)(int);
+typedef int (*PluginParseFn)(const int*, int);
+}
+
+// A grammar plugin loaded with dlopen; unloaded when destroyed. Loaded from
+// a private copy of the file, so a new build of a plugin at a path that is
+// still loaded is loaded as a new object.
+class GrammarPlugin {
+  void* handle;
+  string generator;
+  string grammarHash;
+  PluginParseFn parseFn;
+  // ids of the terminals that can be read (not ε or $), by name
+  unordered_map<string, int> terminalIds;
+
+  void* symbol(const char* name) const;
+
+ public:
+  // throws a message (string) if path can't be loaded or was built for
+  // another ABI version
+  GrammarPlugin(const string& path);
+  ~GrammarPlugin();
+  GrammarPlugin(const GrammarPlugin&) = delete;
+  GrammarPlugin& operator=(const GrammarPlugin&) = delete;
+  const string& getGenerator() const;
+  const string& getGrammarHash() const;
+  // tokens are terminal names, ending with $ (as for LL1Parser)
+  bool predictiveParsing(const vector<string>& tokens) const;
+};
+
+#endif
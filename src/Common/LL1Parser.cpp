@@ -0,0 +1,441 @@
+#include "LL1Parser.hpp"
+
+LL1Parser::LL1Parser(const string& path) {
+  this->totNumSyms = 0;
+  this->lookahead = 1;
+  this->dirPath = (path != "") ? path : ".";
+
+  ifstream inFileLL1;
+  inFileLL1.open(this->dirPath + "/" + LL1_GRAMMAR_FILE_NAME);
+  // read LL1 grammar from the file
+  this->readLL1File(inFileLL1);
+  inFileLL1.close();
+
+  // read parsing table from the file
+
+  ifstream inFileParseTable;
+  inFileParseTable.open(this->dirPath + "/" + PARSE_TABLE_FILE_NAME);
+  this->readParseTableFile(inFileParseTable);
+  inFileParseTable.close();
+}
+
+LL1Parser::LL1Parser(const ParserTables& tables) {
+  this->totNumSyms = 0;
+  this->dirPath = ".";
+  // symbols get the same ids as when read from LL1Grammar.txt
+  vector<Symbol*> syms;
+  for (const auto& [name, isTerminal] : tables.symbols) {
+    Symbol* sym = this->symbolTable.add(name, isTerminal);
+    syms.push_back(sym);
+    ++this->totNumSyms;
+  }
+  this->symbolTable.freeze();
+  this->startSymbol = syms[tables.startSymbol];
+  this->epsSymbol = syms[tables.epsSymbol];
+  this->dollarSymbol = syms[tables.dollarSymbol];
+  for (Symbol* sym : syms) {
+    if (sym == this->epsSymbol || sym == this->dollarSymbol) continue;
+    if (sym->isTerminal) {
+      this->terminals.push_back(sym);
+    } else {
+      this->nonTerminals.push_back(sym);
+    }
+  }
+
+  this->predictor.reset(new AdaptivePredictor(
+      this->startSymbol, this->dollarSymbol, this->epsSymbol,
+      &this->symbolTable));
+  for (const ParserTables::Rule& rule : tables.rules) {
+    vector<Symbol*> rhs;
+    for (int sym : rule.rhs) rhs.push_back(syms[sym]);
+    this->predictor->addRule(this->addRule(syms[rule.lhs], move(rhs)));
+  }
+  for (const ParserTables::Cell& cell : tables.parseTable) {
+    this->parsingTable[syms[cell.nonTer]][syms[cell.ipSym]] =
+        this->rules[cell.rule].get();
+  }
+  for (int loop : tables.loopNonTerminals) {
+    this->loopNonTerminals.insert(syms[loop]);
+  }
+  this->lookahead = tables.lookahead;
+  for (const ParserTables::Decision& decision : tables.decisions) {
+    auto& alternatives =
+        this->lookaheadTable[syms[decision.nonTer]][syms[decision.ipSym]];
+    for (const auto& [lookaheadIds, rule] : decision.alternatives) {
+      vector<Symbol*> str;
+      for (int sym : lookaheadIds) str.push_back(syms[sym]);
+      alternatives.push_back({str, this->rules[rule].get()});
+    }
+  }
+  for (const auto& [nonTer, ipSym] : tables.adaptiveCells) {
+    this->adaptiveCells[syms[nonTer]].insert(syms[ipSym]);
+  }
+}
+
+bool LL1Parser::predictiveParsing(const vector<string>& tokens) const {
+  int tokenIndex = 0;
+  stack<Symbol*> st;
+  st.push(this->dollarSymbol);
+  st.push(this->startSymbol);
+
+  while (!st.empty()) {
+    cout << "Lookup: [" << st.top()->name() << " " << tokens[tokenIndex]
+         << "]\n";
+    Symbol* stackTop = st.top();
+    Symbol* tokenPtr = this->symbolTable.find(tokens[tokenIndex]);
+    if (tokenPtr == nullptr) {
+      cout << "Unexpected symbol: " << tokens[tokenIndex] << "\n";
+      return false;
+    }
+    if (!tokenPtr->isTerminal || tokenPtr == this->epsSymbol) {
+      cout << "Unexpected symbol: " << tokens[tokenIndex] << "\n";
+      return false;
+    }
+
+    if (stackTop->isTerminal && stackTop->name() == tokens[tokenIndex]) {
+      st.pop();
+      tokenIndex++;
+      cout << "Match found: " << stackTop->name() << "\nStack: " << st
+           << "\nRemaining-I/p: "
+           << make_pair(tokens, make_pair(tokenIndex, tokens.size())) << "\n";
+      if (tokenIndex == tokens.size()) {
+        return (st.size() == 0);
+      }
+    } else if (stackTop->isTerminal) {
+      cout << "Expected: " << stackTop->name()
+           << " Found: " << tokens[tokenIndex] << "\n";
+      return false;
+    } else {
+      ProductionRule* pr = nullptr;
+      auto symParseRow = this->parsingTable.find(stackTop);
+      if (symParseRow != this->parsingTable.end()) {
+        auto cell = symParseRow->second.find(tokenPtr);
+        if (cell != symParseRow->second.end()) pr = cell->second;
+      }
+      // one input symbol is not enough for this cell: look further ahead
+      if (pr == nullptr && this->lookahead > 1) {
+        pr = this->decide(stackTop, tokenPtr, tokens, tokenIndex);
+      }
+      if (pr == nullptr && this->isAdaptiveCell(stackTop, tokenPtr)) {
+        cout << "Adaptive prediction: [" << stackTop->name() << " "
+             << tokenPtr->name() << "]\n";
+        st.pop();
+        pr = this->predictor->predict(stackTop, st, tokens, tokenIndex);
+        st.push(stackTop);
+      }
+      if (pr == nullptr) {
+        cout << "No production rule can be applied!\n";
+        return false;
+      }
+      // the next iteration of a loop reuses its non-terminal on the stack
+      bool iterates = !pr->rhs.empty() && pr->rhs.back() == stackTop &&
+                      this->loopNonTerminals.count(stackTop) > 0;
+      if (!iterates) st.pop();
+      for (auto it = pr->rhs.rbegin() + iterates; it != pr->rhs.rend(); ++it) {
+        if ((*it) == this->epsSymbol) continue;
+        st.push(*it);
+      }
+      cout << "Applying production rule: " << pr << "\nStack: " << st
+           << "\nRemaining-I/p: "
+           << make_pair(tokens, make_pair(tokenIndex, tokens.size())) << "\n";
+    }
+    cout << "===\n";
+  }
+
+  return false;
+}
+
+ProductionRule* LL1Parser::decide(Symbol* nonTer, Symbol* ipSym,
+                                  const vector<string>& tokens,
+                                  int tokenIndex) const {
+  auto row = this->lookaheadTable.find(nonTer);
+  if (row == this->lookaheadTable.end()) return nullptr;
+  auto cell = row->second.find(ipSym);
+  if (cell == row->second.end()) return nullptr;
+
+  // the next k tokens, looked up once (nullptr -> not a symbol)
+  vector<Symbol*> window;
+  for (int i = tokenIndex; i < tokenIndex + this->lookahead; ++i) {
+    window.push_back((i < (int)tokens.size())
+                         ? this->symbolTable.find(tokens[i])
+                         : this->dollarSymbol);
+  }
+  int windowEnd = min(tokenIndex + this->lookahead, (int)tokens.size());
+  cout << "Lookahead: "
+       << make_pair(tokens, make_pair(tokenIndex, windowEnd)) << "\n";
+  for (const auto& alternative : cell->second) {
+    const vector<Symbol*>& str = alternative.first;
+    if (equal(str.begin(), str.end(), window.begin())) {
+      return alternative.second;
+    }
+  }
+  return nullptr;
+}
+
+ProductionRule* LL1Parser::readProductionRule(istream& in) {
+  string tmpStr, sym;
+  // parsing the production rules
+
+  in >> sym;
+  Symbol* lhs = this->symbolTable.find(sym);
+  assert(lhs != nullptr);
+  assert(!lhs->isTerminal);
+
+  in >> tmpStr;
+  assert(tmpStr == "->");
+
+  in >> tmpStr;
+  assert(tmpStr == "[");
+  in >> sym;
+  vector<Symbol*> rhs;
+  while (sym != "]") {
+    Symbol* rhsSym = this->symbolTable.find(sym);
+    assert(rhsSym != nullptr);
+    rhs.push_back(rhsSym);
+    in >> sym;
+  }
+  return this->addRule(lhs, move(rhs));
+}
+
+ProductionRule* LL1Parser::addRule(Symbol* lhs, vector<Symbol*> rhs) {
+  this->rules.emplace_back(new ProductionRule(lhs, move(rhs)));
+  return this->rules.back().get();
+}
+
+void LL1Parser::readParseTableFile(istream& in) {
+  string iStr;
+  in >> iStr;
+  assert(iStr == "===Parse-table-begin:");
+
+  int numEntries;
+  in >> numEntries;
+  string nonTer, inpSym;
+  for (int i = 0; i < numEntries; ++i) {
+    in >> iStr;
+    assert(iStr == "Parse[");
+    in >> nonTer >> inpSym;
+    Symbol* nonTerPtr = this->symbolTable.find(nonTer);
+    Symbol* inpSymPtr = this->symbolTable.find(inpSym);
+    assert(nonTerPtr != nullptr);
+    assert(inpSymPtr != nullptr);
+    in >> iStr;
+    assert(iStr == "]");
+    in >> iStr;
+    assert(iStr == ":");
+
+    // read production rule
+    this->parsingTable[nonTerPtr][inpSymPtr] = this->readProductionRule(in);
+  }
+
+  in >> iStr;
+  assert(iStr == "===Parse-table-end");
+
+  // loops, decisions of an LL(k) grammar and adaptive cells, if any, come
+  // right after the table
+  if (!(in >> iStr)) return;
+  if (iStr == "===Loop-table-begin:") {
+    int numLoops;
+    in >> numLoops;
+    for (int i = 0; i < numLoops; ++i) {
+      in >> iStr;
+      assert(iStr == "Loop[");
+      in >> nonTer;
+      Symbol* nonTerPtr = this->symbolTable.find(nonTer);
+      assert(nonTerPtr != nullptr && !nonTerPtr->isTerminal);
+      in >> iStr;
+      assert(iStr == "]");
+      this->loopNonTerminals.insert(nonTerPtr);
+    }
+    in >> iStr;
+    assert(iStr == "===Loop-table-end");
+    if (!(in >> iStr)) return;
+  }
+  if (iStr == "===LLk-table-begin:") {
+    this->readLookaheadTable(in);
+    if (!(in >> iStr)) return;
+  }
+  if (iStr == "===Adaptive-table-begin:") {
+    int numCells;
+    in >> numCells;
+    for (int i = 0; i < numCells; ++i) {
+      in >> iStr;
+      assert(iStr == "Adaptive[");
+      in >> nonTer >> inpSym;
+      Symbol* nonTerPtr = this->symbolTable.find(nonTer);
+      Symbol* inpSymPtr = this->symbolTable.find(inpSym);
+      assert(nonTerPtr != nullptr);
+      assert(inpSymPtr != nullptr);
+      in >> iStr;
+      assert(iStr == "]");
+      this->adaptiveCells[nonTerPtr].insert(inpSymPtr);
+    }
+    in >> iStr;
+    assert(iStr == "===Adaptive-table-end");
+  }
+}
+
+bool LL1Parser::isAdaptiveCell(Symbol* nonTer, Symbol* ipSym) const {
+  auto row = this->adaptiveCells.find(nonTer);
+  return row != this->adaptiveCells.end() && row->second.count(ipSym) > 0;
+}
+
+void LL1Parser::readLookaheadTable(istream& in) {
+  string iStr, nonTer, inpSym;
+  in >> this->lookahead;
+  int numDecisions;
+  in >> numDecisions;
+  for (int i = 0; i < numDecisions; ++i) {
+    in >> iStr;
+    assert(iStr == "Decide[");
+    in >> nonTer >> inpSym;
+    Symbol* nonTerPtr = this->symbolTable.find(nonTer);
+    Symbol* inpSymPtr = this->symbolTable.find(inpSym);
+    assert(nonTerPtr != nullptr);
+    assert(inpSymPtr != nullptr);
+    in >> iStr;
+    assert(iStr == "]");
+    in >> iStr;
+    assert(iStr == ":");
+
+    int numAlternatives;
+    in >> numAlternatives;
+    auto& alternatives = this->lookaheadTable[nonTerPtr][inpSymPtr];
+    for (int j = 0; j < numAlternatives; ++j) {
+      // "[ t1 t2 ... ]" followed by the rule
+      vector<Symbol*> str;
+      in >> iStr;
+      assert(iStr == "[");
+      for (in >> iStr; iStr != "]"; in >> iStr) {
+        Symbol* sym = this->symbolTable.find(iStr);
+        assert(sym != nullptr && sym->isTerminal);
+        str.push_back(sym);
+      }
+      assert((int)str.size() <= this->lookahead);
+      alternatives.push_back({str, this->readProductionRule(in)});
+    }
+  }
+  in >> iStr;
+  assert(iStr == "===LLk-table-end");
+}
+
+void LL1Parser::readLL1File(istream& in) {
+  string sym, iStr;
+
+  // Check the beginning
+  in >> iStr;
+  assert(iStr == "===LL1-grammar-begin:");
+
+  // read terminals
+  in >> iStr;
+  assert(iStr == "Terminals:");
+  int numTers;
+  in >> numTers;
+
+  for (int i = 0; i < numTers; ++i) {
+    in >> sym;
+    this->terminals.push_back(this->symbolTable.add(sym, true));
+    ++this->totNumSyms;
+  }
+
+  in >> iStr;
+  assert(iStr == "Non-terminals:");
+
+  int numNonTers;
+  in >> numNonTers;
+  for (int i = 0; i < numNonTers; ++i) {
+    in >> sym;
+    assert(this->symbolTable.find(sym) == nullptr);
+    this->nonTerminals.push_back(this->symbolTable.add(sym, false));
+    ++this->totNumSyms;
+  }
+
+  in >> iStr;
+  assert(iStr == "Eps-symbol:");
+
+  in >> sym;
+  assert(this->symbolTable.find(sym) == nullptr);
+  this->epsSymbol = this->symbolTable.add(sym, true);
+  ++this->totNumSyms;
+
+  in >> iStr;
+  assert(iStr == "Dollar-symbol:");
+
+  in >> sym;
+  assert(this->symbolTable.find(sym) == nullptr);
+  this->dollarSymbol = this->symbolTable.add(sym, true);
+  ++this->totNumSyms;
+  // the parse table and the token stream only look names up from here on
+  this->symbolTable.freeze();
+
+  in >> iStr;
+  assert(iStr == "Start-symbol:");
+
+  in >> sym;
+  this->startSymbol = this->symbolTable.find(sym);
+  assert(this->startSymbol != nullptr);
+  assert(!this->startSymbol->isTerminal);
+
+  in >> iStr;
+  assert(iStr == "===Production-rules-begin:");
+  // the rules are only simulated by adaptive prediction
+  this->predictor.reset(new AdaptivePredictor(
+      this->startSymbol, this->dollarSymbol, this->epsSymbol,
+      &this->symbolTable));
+  int numRules;
+  in >> numRules;
+  for (int i = 0; i < numRules; ++i) {
+    this->predictor->addRule(this->readProductionRule(in));
+  }
+  in >> iStr;
+  assert(iStr == "===Production-rules-end");
+}
+
+void LL1Parser::printCFG() const {
+  cout << "Terminals: ";
+  for (Symbol* terminal : this->terminals) {
+    cout << terminal->name() << " ";
+  }
+  cout << "\n";
+
+  cout << "Non-terminals: ";
+  for (Symbol* nonTerminal : this->nonTerminals) {
+    cout << nonTerminal->name() << " ";
+  }
+  cout << "\n";
+
+  cout << "Start symbol: " << this->startSymbol->name() << "\n";
+}
+
+void LL1Parser::printParseTable() const {
+  cout << "===Parse-table-begin:\n";
+  for (auto nonTerRow : this->parsingTable) {
+    for (auto ipSymCell : nonTerRow.second) {
+      cout << "Parse[ " << nonTerRow.first->name() << " "
+           << ipSymCell.first->name() << " ] : ";
+      cout << ipSymCell.second << "\n";
+    }
+  }
+  cout << "===Parse-table-end\n";
+}
+
+void LL1Parser::setDirPath(const string& dirPath) { this->dirPath = dirPath; }
+
+ostream& operator<<(ostream& os, stack<Symbol*> st) {
+  os << "[ ";
+  while (!st.empty()) {
+    os << st.top()->name() << " ";
+    st.pop();
+  }
+  os << "] ";
+  return os;
+}
+
+ostream& operator<<(ostream& os,
+                    const pair<vector<string>, pair<int, int>>& vec) {
+  os << "[ ";
+  for (int i = vec.second.first; i < vec.second.second; ++i) {
+    os << vec.first[i] << " ";
+  }
+  os << "] ";
+  return os;
+}
\ No newline at end of file
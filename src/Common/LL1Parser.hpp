@@ -0,0 +1,103 @@
+#ifndef __COMMON_LL1_PARSER_HPP__
+#define __COMMON_LL1_PARSER_HPP__
+
+#include <algorithm>
+#include <cassert>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <stack>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "AdaptivePredictor.hpp"
+#include "ParserTables.hpp"
+#include "constants.hpp"
+#include "structs.hpp"
+
+using namespace std;
+
+class LL1Parser {
+  int totNumSyms;
+  Symbol* startSymbol;
+  Symbol* epsSymbol;
+  Symbol* dollarSymbol;
+  vector<Symbol*> terminals;
+  vector<Symbol*> nonTerminals;
+
+  // every symbol (name, terminal flag), indexed by its id
+  SymbolTable symbolTable;
+  // every production rule the tables below point to
+  vector<unique_ptr<ProductionRule>> rules;
+
+  // Parsing table:
+  //
+  //    map (current non-terminal ->
+  //          [
+  //              map (current input symbol ->
+  //                [
+  //                    production rule to be used for the pair
+  //                    {current non-terminal, current-input-symbol}
+  //                ]
+  //              )
+  //          ]
+  //        )
+  unordered_map<Symbol*, unordered_map<Symbol*, ProductionRule*>> parsingTable;
+  // Non-terminals run as loops: applying a rule "R -> [ ... R ]" leaves R on
+  // the stack and pushes the rest of the rhs on top of it
+  unordered_set<Symbol*> loopNonTerminals;
+  // Cells of an LL(k) grammar that need more than one input symbol (not in
+  // parsingTable):
+  //
+  //    lookaheadTable[current non-terminal][current input symbol] =
+  //          [ (lookahead string starting with the input symbol, rule) ]
+  unordered_map<Symbol*,
+                unordered_map<Symbol*,
+                              vector<pair<vector<Symbol*>, ProductionRule*>>>>
+      lookaheadTable;
+  // longest lookahead string in lookaheadTable (1 -> LL(1) grammar)
+  int lookahead;
+  // Cells left to adaptive prediction at run time:
+  //
+  //    adaptiveCells[current non-terminal] = { current input symbols }
+  unordered_map<Symbol*, unordered_set<Symbol*>> adaptiveCells;
+  // simulates the production rules of the grammar for adaptiveCells
+  unique_ptr<AdaptivePredictor> predictor;
+
+  // reads "A -> [ ... ]" of a table entry
+  ProductionRule* readProductionRule(istream& in);
+  ProductionRule* addRule(Symbol* lhs, vector<Symbol*> rhs);
+  // reads the LLk-table section of the parse table file (after its header)
+  void readLookaheadTable(istream& in);
+  bool isAdaptiveCell(Symbol* nonTer, Symbol* ipSym) const;
+  // rule for nonTer whose lookahead string matches tokens[tokenIndex..]
+  // (tokens past the end read as $), nullptr if there is none
+  ProductionRule* decide(Symbol* nonTer, Symbol* ipSym,
+                         const vector<string>& tokens, int tokenIndex) const;
+
+  // Relative path of grammar's folder from current directory
+  string dirPath;
+
+ public:
+  // reads the files generated into the grammar's directory at path
+  LL1Parser(const string& path);
+  // takes the tables of a grammar compiled in the same process
+  LL1Parser(const ParserTables& tables);
+  bool predictiveParsing(const vector<string>& tokens) const;
+  void setDirPath(const string& dirPath);
+  void readLL1File(istream& in);
+  void readParseTableFile(istream& in);
+  void printCFG() const;
+  void printParseTable() const;
+};
+
+// Operator-overloadings for easy printing
+// print stack
+ostream& operator<<(ostream& os, stack<Symbol*> st);
+// print vector from pair.second.first to pair.second.second
+// (pair.second.first inclusive and pair.second.second exclusive)
+ostream& operator<<(ostream& os,
+                    const pair<vector<string>, pair<int, int>>& vec);
+#endif
\ No newline at end of file
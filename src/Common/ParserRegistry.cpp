@@ -0,0 +1,30 @@
+#include "ParserRegistry.hpp"
+
+void ParserRegistry::add(const string& name, unique_ptr<LL1Parser> parser) {
+  this->plugins.erase(name);
+  this->parsers[name] = move(parser);
+}
+
+void ParserRegistry::loadPlugin(const string& name, const string& path) {
+  // loaded before anything is replaced, so a bad plugin leaves the old one
+  unique_ptr<GrammarPlugin> plugin(new GrammarPlugin(path));
+  this->parsers.erase(name);
+  this->plugins[name] = move(plugin);
+}
+
+bool ParserRegistry::contains(const string& name) const {
+  return this->parsers.count(name) > 0 || this->plugins.count(name) > 0;
+}
+
+bool ParserRegistry::predictiveParsing(const string& name,
+                                       const vector<string>& tokens) const {
+  auto parser = this->parsers.find(name);
+  if (parser != this->parsers.end()) {
+    return parser->second->predictiveParsing(tokens);
+  }
+  auto plugin = this->plugins.find(name);
+  if (plugin != this->plugins.end()) {
+    return plugin->second->predictiveParsing(tokens);
+  }
+  return false;
+}
@@ -0,0 +1,33 @@
+#ifndef __COMMON_PARSER_REGISTRY_HPP__
+#define __COMMON_PARSER_REGISTRY_HPP__
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "GrammarPlugin.hpp"
+#include "LL1Parser.hpp"
+
+using namespace std;
+
+// Parsers by grammar name: table-driven LL1Parsers and grammar plugins side by
+// side, so that callers don't depend on which one a grammar has. Adding a
+// grammar under a name in use replaces the old parser (e.g. to load a new
+// build of a plugin). Not synchronized: add and load before parsing from
+// several threads.
+class ParserRegistry {
+  unordered_map<string, unique_ptr<LL1Parser>> parsers;
+  unordered_map<string, unique_ptr<GrammarPlugin>> plugins;
+
+ public:
+  void add(const string& name, unique_ptr<LL1Parser> parser);
+  // throws a message (string) if the plugin can't be loaded
+  void loadPlugin(const string& name, const string& path);
+  bool contains(const string& name) const;
+  // tokens end with $; false if there is no grammar with that name
+  bool predictiveParsing(const string& name,
+                         const vector<string>& tokens) const;
+};
+
+#endif
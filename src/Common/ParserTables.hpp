@@ -0,0 +1,50 @@
+#ifndef __COMMON_PARSER_TABLES_HPP__
+#define __COMMON_PARSER_TABLES_HPP__
+
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// What the parser needs of a compiled grammar, handed over in memory (see
+// LL1::getParserTables) instead of through LL1Grammar.txt and ParseTable.txt.
+// Symbols are referred to by their position in symbols, rules by their
+// position in rules.
+struct ParserTables {
+  struct Rule {
+    int lhs;
+    vector<int> rhs;
+  };
+  struct Cell {
+    int nonTer;
+    int ipSym;
+    int rule;
+  };
+  // cell settled by looking at up to lookahead input symbols
+  struct Decision {
+    int nonTer;
+    int ipSym;
+    // (lookahead string starting with ipSym, rule)
+    vector<pair<vector<int>, int>> alternatives;
+  };
+
+  // (name, is terminal) of the terminals, the non-terminals, ε and $, in the
+  // order of LL1Grammar.txt
+  vector<pair<string, bool>> symbols;
+  int startSymbol;
+  int epsSymbol;
+  int dollarSymbol;
+  // in the order of LL1Grammar.txt (adaptive prediction tries them in order)
+  vector<Rule> rules;
+  vector<Cell> parseTable;
+  // non-terminals run as loops (see LL1Parser::loopNonTerminals)
+  vector<int> loopNonTerminals;
+  // longest lookahead string of the decisions (1 -> there are none)
+  int lookahead;
+  vector<Decision> decisions;
+  // (non-terminal, input symbol) cells left to adaptive prediction
+  vector<pair<int, int>> adaptiveCells;
+};
+
+#endif
@@ -0,0 +1,70 @@
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include "GrammarPlugin.hpp"
+#include "ParserRegistry.hpp"
+#include "constants.hpp"
+
+// Check that a new build of a plugin replaces the loaded one: every plugin
+// given is in turn renamed over one path (as a build writing it anew would)
+// and loaded under one name, both while the previous build is still loaded.
+// The loaded plugin must then be the one just given, and accept the sentence
+// given with it.
+
+static bool copyFile(const string& from, const string& to) {
+  ifstream in(from, ios::binary);
+  ofstream out(to, ios::binary);
+  if (in) out << in.rdbuf();
+  out.close();
+  return in && out;
+}
+
+int main(int argc, char* argv[]) {
+  if (argc < 6 || argc % 2 != 0) {
+    cout << "Usage: " << argv[0] << " path plugin sentence plugin sentence...\n"
+         << "  path      where the plugins are renamed to, one at a time\n"
+         << "  plugin    builds of plugins of different grammars\n"
+         << "  sentence  terminals (separated by spaces) of a sentence of\n"
+         << "            the plugin's grammar\n";
+    return EXIT_FAILURE;
+  }
+  string path = argv[1];
+  string newPath = path + ".new";
+  ParserRegistry registry;
+  unique_ptr<GrammarPlugin> previous;
+  bool failed = false;
+  try {
+    for (int i = 2; i < argc; i += 2) {
+      string expectedHash = GrammarPlugin(argv[i]).getGrammarHash();
+      vector<string> tokens;
+      istringstream sentence(argv[i + 1]);
+      for (string token; sentence >> token;) tokens.push_back(token);
+      tokens.push_back(DOLLAR_SYMBOL);
+      if (!copyFile(argv[i], newPath) ||
+          rename(newPath.c_str(), path.c_str()) != 0) {
+        throw "can't replace " + path + " with " + argv[i];
+      }
+      unique_ptr<GrammarPlugin> plugin(new GrammarPlugin(path));
+      registry.loadPlugin("grammar", path);
+      if (plugin->getGrammarHash() != expectedHash) {
+        cout << argv[i] << ": loaded the plugin of grammar "
+             << plugin->getGrammarHash() << ", expected " << expectedHash
+             << "\n";
+        failed = true;
+      }
+      if (!registry.predictiveParsing("grammar", tokens)) {
+        cout << argv[i] << ": the registry rejects \"" << argv[i + 1]
+             << "\"\n";
+        failed = true;
+      }
+      previous = move(plugin);
+    }
+  } catch (string message) {
+    cout << "Error: " << message << "\n";
+    return EXIT_FAILURE;
+  }
+  if (!failed) cout << "Every new build of " << path << " was loaded\n";
+  return failed ? EXIT_FAILURE : 0;
+}
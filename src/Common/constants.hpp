@@ -7,10 +7,30 @@ using namespace std;
 const string EPSILON_SYMBOL = "ε";
 const string DOLLAR_SYMBOL = "$";
 const string NOT_LL1_EXCEPTION = "The CFG is not an LL(1) grammar";
+const string NOT_LLK_EXCEPTION =
+    "The CFG is not an LL(k) grammar for the given lookahead";
 const string PRODUCTION_RULE_OR = "|";
+// EBNF groups on the rhs of a rule: "[* a b ]*" repeats a b zero or more
+// times, "[? a b ]?" is optional; both may have alternatives and nest
+const string EBNF_REPEAT_BEGIN = "[*";
+const string EBNF_REPEAT_END = "]*";
+const string EBNF_OPTIONAL_BEGIN = "[?";
+const string EBNF_OPTIONAL_END = "]?";
 
+// grammar of a grammar directory (see grammar_1/), read in batch mode
+const string GRAMMAR_FILE_NAME = "Grammar.txt";
 const string FIRST_FOLLOW_FILE_NAME = "First-Follow.txt";
 const string LL1_GRAMMAR_FILE_NAME = "LL1Grammar.txt";
 const string PARSE_TABLE_FILE_NAME = "ParseTable.txt";
+// rewritten grammar, first/follow sets and parsing table of the last
+// compilation, read back by incremental compilations
+const string COMPILATION_STATE_FILE_NAME = "LL1State.txt";
+
+// Bumped whenever the generated files change for the same grammar, so that
+// cached files of an older generator are not reused
+const string GENERATOR_VERSION = "LL1-Parser/4";
+// Last line of every generated file: tag followed by the hash of the
+// (normalized) grammar and the generator version the file was made from
+const string GRAMMAR_HASH_TAG = "===Grammar-hash:";
 
 #endif
\ No newline at end of file
@@ -0,0 +1,15 @@
+#include "structs.hpp"
+
+ostream& operator<<(ostream& os, const Symbol* sym) {
+  os << sym->name() << " ";
+  return os;
+}
+
+ostream& operator<<(ostream& os, const ProductionRule* pr) {
+  os << pr->lhs->name() << " -> [ ";
+  for (Symbol* rhsSym : pr->rhs) {
+    os << rhsSym->name() << " ";
+  }
+  os << "] ";
+  return os;
+}
@@ -3,31 +3,25 @@
 
 #include <iostream>
 #include <string>
+#include <utility>
 #include <vector>
 
-using namespace std;
+#include "symbolTable.hpp"
 
-struct Symbol {
-  int id;
-  string symbol;
-  bool isTerminal;
-  Symbol(int id, string symbol, bool isTerminal) {
-    this->id = id;
-    this->symbol = symbol;
-    this->isTerminal = isTerminal;
-  }
-  // Operator-overloading for easy output (must be supplied externally)
-  friend ostream& operator<<(ostream& os, const Symbol* sym);
-};
+using namespace std;
 
 struct ProductionRule {
+  // position of the rule in its grammar's rule list (-1 -> not assigned)
+  int id;
   Symbol* lhs;
   vector<Symbol*> rhs;
-  ProductionRule(Symbol* lhs, vector<Symbol*>& rhs) {
+  // rhs is moved in: pass an rvalue (or a copy) if it's still needed
+  ProductionRule(Symbol* lhs, vector<Symbol*> rhs) {
+    this->id = -1;
     this->lhs = lhs;
-    this->rhs = rhs;
+    this->rhs = move(rhs);
   }
-  // Operator-overloading for easy output (must be supplied externally)
+  // Operator-overloading for easy output (see structs.cpp)
   friend ostream& operator<<(ostream& os, const ProductionRule* sym);
 };
 
@@ -0,0 +1,127 @@
+#include "symbolTable.hpp"
+
+#include <algorithm>
+
+SymbolTable::SymbolTable() {
+  this->numFrozen = 0;
+  this->numRecent = 0;
+}
+
+uint64_t SymbolTable::hashName(string_view name) {
+  // FNV-1a
+  uint64_t hash = 0xcbf29ce484222325ULL;
+  for (unsigned char c : name) {
+    hash = (hash ^ c) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+uint64_t SymbolTable::mix(uint64_t hash, uint32_t seed) {
+  // splitmix64 finalizer of the hash perturbed by the seed
+  uint64_t x = hash ^ (seed * 0x9e3779b97f4a7c15ULL);
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
+void SymbolTable::insertRecent(int id) {
+  // keep the load factor <= 1/2
+  if (2 * (this->numRecent + 1) > (int)this->recentSlots.size()) {
+    vector<int> oldSlots(max<size_t>(16, 2 * this->recentSlots.size()), -1);
+    oldSlots.swap(this->recentSlots);
+    this->numRecent = 0;
+    for (int oldId : oldSlots) {
+      if (oldId >= 0) this->insertRecent(oldId);
+    }
+  }
+  size_t mask = this->recentSlots.size() - 1;
+  size_t slot = hashName(this->name(id)) & mask;
+  while (this->recentSlots[slot] >= 0) slot = (slot + 1) & mask;
+  this->recentSlots[slot] = id;
+  this->numRecent++;
+}
+
+Symbol* SymbolTable::add(string_view name, bool isTerminal) {
+  int id = this->nameOffsets.size();
+  this->nameOffsets.push_back(this->namePool.size());
+  this->nameLengths.push_back(name.size());
+  this->terminalFlags.push_back(isTerminal);
+  this->namePool.append(name);
+  this->handles.emplace_back(id, isTerminal, this);
+  this->insertRecent(id);
+  return &this->handles.back();
+}
+
+Symbol* SymbolTable::find(string_view name) const {
+  uint64_t hash = hashName(name);
+  if (this->numFrozen > 0) {
+    uint32_t seed = this->bucketSeeds[hash % this->bucketSeeds.size()];
+    int id = this->slotIds[mix(hash, seed) % this->slotIds.size()];
+    if (id >= 0 && this->name(id) == name) return this->at(id);
+  }
+  if (this->numRecent > 0) {
+    size_t mask = this->recentSlots.size() - 1;
+    for (size_t slot = hash & mask; this->recentSlots[slot] >= 0;
+         slot = (slot + 1) & mask) {
+      int id = this->recentSlots[slot];
+      if (this->name(id) == name) return this->at(id);
+    }
+  }
+  return nullptr;
+}
+
+Symbol* SymbolTable::at(int id) const {
+  return const_cast<Symbol*>(&this->handles[id]);
+}
+
+int SymbolTable::size() const { return this->nameOffsets.size(); }
+
+void SymbolTable::freeze() {
+  // Hash and displace: names are spread over ~n/4 buckets; buckets are placed
+  // largest first, each trying seeds till all of its names land on free slots
+  int n = this->size();
+  vector<uint64_t> hashes(n);
+  for (int id = 0; id < n; ++id) hashes[id] = hashName(this->name(id));
+
+  int numBuckets = max(1, n / 4);
+  int numSlots = max(1, n + n / 4);
+  vector<vector<int>> buckets(numBuckets);
+  for (int id = 0; id < n; ++id) {
+    buckets[hashes[id] % numBuckets].push_back(id);
+  }
+  vector<int> order(numBuckets);
+  for (int b = 0; b < numBuckets; ++b) order[b] = b;
+  stable_sort(order.begin(), order.end(), [&](int a, int b) {
+    return buckets[a].size() > buckets[b].size();
+  });
+
+  this->bucketSeeds.assign(numBuckets, 0);
+  this->slotIds.assign(numSlots, -1);
+  vector<int> candidateSlots;
+  for (int b : order) {
+    if (buckets[b].empty()) break;
+    for (uint32_t seed = 1;; ++seed) {
+      candidateSlots.clear();
+      bool fits = true;
+      for (int id : buckets[b]) {
+        int slot = mix(hashes[id], seed) % numSlots;
+        if (this->slotIds[slot] >= 0 ||
+            std::find(candidateSlots.begin(), candidateSlots.end(), slot) !=
+                candidateSlots.end()) {
+          fits = false;
+          break;
+        }
+        candidateSlots.push_back(slot);
+      }
+      if (!fits) continue;
+      for (int k = 0; k < (int)buckets[b].size(); ++k) {
+        this->slotIds[candidateSlots[k]] = buckets[b][k];
+      }
+      this->bucketSeeds[b] = seed;
+      break;
+    }
+  }
+  this->numFrozen = n;
+  this->recentSlots.clear();
+  this->numRecent = 0;
+}
@@ -0,0 +1,77 @@
+#ifndef __COMMON_SYMBOL_TABLE_HPP__
+#define __COMMON_SYMBOL_TABLE_HPP__
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+class SymbolTable;
+
+// Handle of a symbol interned in a SymbolTable (the table owns the name)
+struct Symbol {
+  int id;
+  bool isTerminal;
+  const SymbolTable* table;
+  Symbol(int id, bool isTerminal, const SymbolTable* table) {
+    this->id = id;
+    this->isTerminal = isTerminal;
+    this->table = table;
+  }
+  string_view name() const;
+  // Operator-overloading for easy output (see structs.cpp)
+  friend ostream& operator<<(ostream& os, const Symbol* sym);
+};
+
+// Interned symbols of a grammar.
+//
+// Every name is stored once, back to back in a single string pool. The data
+// of the symbol with id i is spread over parallel arrays (offset and length of
+// its name in the pool, terminal flag), so scans over symbols touch only the
+// arrays they need. Name -> id lookups use a perfect hash over all the symbols
+// present when freeze() was called (one probe, one name comparison); symbols
+// added after that go to a small open-addressing table until the next freeze.
+class SymbolTable {
+  string namePool;
+  vector<uint32_t> nameOffsets;
+  vector<uint32_t> nameLengths;
+  vector<uint8_t> terminalFlags;
+  // Symbol handles, indexed by id (a deque never moves its elements)
+  deque<Symbol> handles;
+
+  // perfect hash of the first numFrozen symbols: the name with hash h goes to
+  // slot mix(h, bucketSeeds[h % numBuckets]) % slotIds.size()
+  vector<uint32_t> bucketSeeds;
+  vector<int> slotIds;
+  int numFrozen;
+  // open addressing (linear probing) for the symbols added after freeze()
+  vector<int> recentSlots;
+  int numRecent;
+
+  static uint64_t hashName(string_view name);
+  static uint64_t mix(uint64_t hash, uint32_t seed);
+  void insertRecent(int id);
+
+ public:
+  SymbolTable();
+  // interns a new symbol, the name must not be in the table yet
+  Symbol* add(string_view name, bool isTerminal);
+  // nullptr if there is no symbol with that name
+  Symbol* find(string_view name) const;
+  Symbol* at(int id) const;
+  string_view name(int id) const {
+    return string_view(this->namePool.data() + this->nameOffsets[id],
+                       this->nameLengths[id]);
+  }
+  bool isTerminal(int id) const { return this->terminalFlags[id]; }
+  int size() const;
+  // (re)builds the perfect hash over all the symbols added so far
+  void freeze();
+};
+
+inline string_view Symbol::name() const { return this->table->name(this->id); }
+
+#endif
@@ -0,0 +1,60 @@
+#include "ArtifactCache.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+#include <unistd.h>
+
+#include "../Common/constants.hpp"
+
+namespace fs = std::filesystem;
+
+ArtifactCache::ArtifactCache(const string& cacheDir) {
+  this->cacheDir = cacheDir;
+}
+
+string ArtifactCache::pathOf(const string& dirPath, const string& fileName) {
+  return (dirPath != "" ? dirPath : ".") + "/" + fileName;
+}
+
+bool ArtifactCache::isUpToDate(const string& filePath,
+                               const string& grammarHash) {
+  ifstream inFile(filePath, ios::binary);
+  if (!inFile) return false;
+  // only the tail of the file holds the hash
+  string expected = GRAMMAR_HASH_TAG + " " + grammarHash + "\n";
+  inFile.seekg(0, ios::end);
+  streamoff size = inFile.tellg();
+  if (size < (streamoff)expected.size()) return false;
+  inFile.seekg(size - expected.size());
+  string tail(expected.size(), '\0');
+  inFile.read(&tail[0], tail.size());
+  return inFile && tail == expected;
+}
+
+bool ArtifactCache::restore(const string& grammarHash, const string& fileName,
+                            const string& dirPath) const {
+  if (this->cacheDir == "") return false;
+  string cachedPath = pathOf(this->cacheDir + "/" + grammarHash, fileName);
+  if (!isUpToDate(cachedPath, grammarHash)) return false;
+  error_code ec;
+  fs::copy_file(cachedPath, pathOf(dirPath, fileName),
+                fs::copy_options::overwrite_existing, ec);
+  return !ec;
+}
+
+void ArtifactCache::store(const string& grammarHash, const string& fileName,
+                          const string& dirPath) const {
+  if (this->cacheDir == "") return;
+  // several builds may share the cache: copy under a private name and rename,
+  // so readers never see a partially written file
+  string entryDir = this->cacheDir + "/" + grammarHash;
+  string tmpPath = pathOf(entryDir, fileName + ".tmp" + to_string(getpid()));
+  error_code ec;
+  fs::create_directories(entryDir, ec);
+  if (ec) return;
+  fs::copy_file(pathOf(dirPath, fileName), tmpPath,
+                fs::copy_options::overwrite_existing, ec);
+  if (!ec) fs::rename(tmpPath, pathOf(entryDir, fileName), ec);
+  if (ec) fs::remove(tmpPath, ec);
+}
@@ -0,0 +1,33 @@
+#ifndef __ARTIFACT_CACHE_HPP__
+#define __ARTIFACT_CACHE_HPP__
+
+#include <string>
+
+using namespace std;
+
+// Generated files addressed by the hash of the grammar they were made from.
+//
+// A generated file records that hash on its last line (GRAMMAR_HASH_TAG), so
+// a file in the output directory with the right hash is simply kept. Files
+// are also kept in a cache directory shared by all grammars, as
+// <cacheDir>/<grammar-hash>/<file-name>, so a grammar generated once (by any
+// build) is never generated again.
+class ArtifactCache {
+  // "" -> no shared cache, only the output directory is checked
+  string cacheDir;
+
+  static string pathOf(const string& dirPath, const string& fileName);
+
+ public:
+  ArtifactCache(const string& cacheDir);
+  // true if the file exists and was generated from grammarHash
+  static bool isUpToDate(const string& filePath, const string& grammarHash);
+  // copies the cached file to dirPath, false if it isn't cached
+  bool restore(const string& grammarHash, const string& fileName,
+               const string& dirPath) const;
+  // copies dirPath/fileName into the cache
+  void store(const string& grammarHash, const string& fileName,
+             const string& dirPath) const;
+};
+
+#endif
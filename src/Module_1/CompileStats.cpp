@@ -0,0 +1,55 @@
+#include "CompileStats.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <sys/resource.h>
+
+// Counted by replacing the global operator new; the array forms call this
+// one. The nothrow form is replaced too, so that memory checkers (which
+// intercept it) see it freed by the matching delete. Until countAllocations
+// is called, operator new only reads a flag.
+static atomic<bool> isCounting(false);
+static atomic<long long> numAllocations(0);
+static atomic<long long> numAllocatedBytes(0);
+
+void* operator new(size_t size) {
+  if (isCounting.load(memory_order_relaxed)) {
+    numAllocations.fetch_add(1, memory_order_relaxed);
+    numAllocatedBytes.fetch_add(size, memory_order_relaxed);
+  }
+  void* ptr = malloc(size > 0 ? size : 1);
+  if (ptr == nullptr) throw bad_alloc();
+  return ptr;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+  try {
+    return ::operator new(size);
+  } catch (const bad_alloc&) {
+    return nullptr;
+  }
+}
+
+void operator delete(void* ptr) noexcept { free(ptr); }
+
+void operator delete(void* ptr, const nothrow_t&) noexcept { free(ptr); }
+
+void operator delete(void* ptr, size_t) noexcept { free(ptr); }
+
+void countAllocations() { isCounting.store(true, memory_order_relaxed); }
+
+long long allocationCount() {
+  return numAllocations.load(memory_order_relaxed);
+}
+
+long long allocatedBytes() {
+  return numAllocatedBytes.load(memory_order_relaxed);
+}
+
+long peakRssKb() {
+  struct rusage usage;
+  if (getrusage(RUSAGE_SELF, &usage) != 0) return 0;
+  // kilobytes on Linux
+  return usage.ru_maxrss;
+}
@@ -0,0 +1,35 @@
+#ifndef __COMPILE_STATS_HPP__
+#define __COMPILE_STATS_HPP__
+
+#include <string>
+
+using namespace std;
+
+// Cost of one phase of a grammar compilation (see LL1::runPhase)
+struct PhaseStats {
+  string name;
+  double milliseconds;
+  // growth of the peak resident set size of the process during the phase
+  long peakRssDeltaKb;
+  // operator new calls and bytes they asked for during the phase (by every
+  // thread of the process)
+  long long numAllocations;
+  long long bytesAllocated;
+  // sizes of the grammar before and after the phase
+  int rulesBefore, rulesAfter;
+  int nonTersBefore, nonTersAfter;
+  int symbolsBefore, symbolsAfter;
+  // passes or worklist steps of the phase's fixed points (0 -> none)
+  long long numIterations;
+};
+
+// makes operator new count its calls and requested bytes from now on; until
+// then nothing is counted, so that allocation costs nothing extra
+void countAllocations();
+// operator new calls and requested bytes since countAllocations was called
+long long allocationCount();
+long long allocatedBytes();
+// peak resident set size of the process so far
+long peakRssKb();
+
+#endif
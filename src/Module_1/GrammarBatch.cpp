@@ -0,0 +1,134 @@
+#include "GrammarBatch.hpp"
+
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+#include "../Common/constants.hpp"
+#include "ArtifactCache.hpp"
+#include "ThreadPool.hpp"
+
+GrammarBatch::GrammarBatch(const vector<string>& dirPaths,
+                           const LL1Options& options, bool force,
+                           const string& statsFileName) {
+  this->options = options;
+  // the grammars are what runs in parallel, not the phases of each one
+  this->options.numThreads = 1;
+  this->options.exitOnError = false;
+  this->force = force;
+  this->statsFileName = statsFileName;
+  this->milliseconds = 0;
+  this->numThreads = 1;
+  for (const string& dirPath : dirPaths) {
+    GrammarJob job;
+    job.dirPath = dirPath;
+    job.status = "failed";
+    job.milliseconds = 0;
+    job.numNonTers = job.numRules = job.numTableEntries = job.numConflicts = -1;
+    this->jobs.push_back(job);
+  }
+}
+
+void GrammarBatch::compileJob(GrammarJob& job) const {
+  auto start = chrono::steady_clock::now();
+  ostringstream log;
+  LL1Options options = this->options;
+  options.grammarPath = job.dirPath + "/" + GRAMMAR_FILE_NAME;
+  options.log = &log;
+  unique_ptr<LL1> cfg;
+  try {
+    cfg.reset(new LL1(options));
+    const string& grammarHash = cfg->getGrammarHash();
+    bool upToDate = !this->force;
+    for (const string& fileName : {FIRST_FOLLOW_FILE_NAME,
+                                   LL1_GRAMMAR_FILE_NAME,
+                                   PARSE_TABLE_FILE_NAME}) {
+      upToDate = upToDate && ArtifactCache::isUpToDate(
+                                 job.dirPath + "/" + fileName, grammarHash);
+    }
+    if (upToDate) {
+      job.status = "up to date";
+    } else {
+      cfg->compile();
+      cfg->setDirPath(job.dirPath);
+      cfg->createFirstFollowFile();
+      cfg->createLL1GrammarFile();
+      cfg->createParseTableFile();
+      if (this->statsFileName != "") {
+        cfg->createStatsFile(job.dirPath + "/" + this->statsFileName);
+      }
+      job.status = "ok";
+    }
+  } catch (string message) {
+    // already printed on log
+    job.status = "failed";
+  }
+  if (cfg != nullptr && job.status != "up to date") {
+    job.numNonTers = cfg->numNonTerminals();
+    job.numRules = cfg->numProductionRules();
+    job.numConflicts = cfg->numConflicts();
+    // a failed compilation has no complete table
+    if (job.status == "ok") job.numTableEntries = cfg->numTableEntries();
+  }
+  job.log = log.str();
+  job.milliseconds = chrono::duration<double, milli>(
+                         chrono::steady_clock::now() - start)
+                         .count();
+}
+
+void GrammarBatch::run(int numThreads) {
+  auto start = chrono::steady_clock::now();
+  this->numThreads = max(1, min(numThreads, (int)this->jobs.size()));
+  if (this->numThreads == 1) {
+    for (GrammarJob& job : this->jobs) this->compileJob(job);
+  } else {
+    ThreadPool threadPool(this->numThreads);
+    threadPool.parallelFor(this->jobs.size(), [this](int i) {
+      this->compileJob(this->jobs[i]);
+    });
+  }
+  this->milliseconds = chrono::duration<double, milli>(
+                           chrono::steady_clock::now() - start)
+                           .count();
+}
+
+void GrammarBatch::printSummary(ostream& out) const {
+  for (const GrammarJob& job : this->jobs) {
+    if (job.log == "") continue;
+    out << "=== " << job.dirPath << "\n" << job.log;
+  }
+
+  int nameWidth = 7;
+  for (const GrammarJob& job : this->jobs) {
+    nameWidth = max(nameWidth, (int)job.dirPath.size());
+  }
+  auto count = [](int value) { return value >= 0 ? to_string(value) : "-"; };
+  streamsize precision = out.precision();
+  out << left << setw(nameWidth) << "Grammar" << right << setw(12) << "Status"
+      << setw(11) << "Time (ms)" << setw(15) << "Non-terminals" << setw(7)
+      << "Rules" << setw(15) << "Table entries" << setw(11) << "Conflicts"
+      << "\n";
+  double totalMilliseconds = 0;
+  int numFailed = 0;
+  for (const GrammarJob& job : this->jobs) {
+    totalMilliseconds += job.milliseconds;
+    if (job.status == "failed") ++numFailed;
+    out << left << setw(nameWidth) << job.dirPath << right << setw(12)
+        << job.status << setw(11) << fixed << setprecision(1)
+        << job.milliseconds << setw(15) << count(job.numNonTers) << setw(7)
+        << count(job.numRules) << setw(15) << count(job.numTableEntries)
+        << setw(11) << count(job.numConflicts) << "\n";
+  }
+  out << this->jobs.size() << " grammars, " << numFailed << " failed: "
+      << fixed << setprecision(1) << totalMilliseconds << " ms of work in "
+      << this->milliseconds << " ms on " << this->numThreads << " threads\n";
+  out.unsetf(ios::floatfield);
+  out.precision(precision);
+}
+
+bool GrammarBatch::succeeded() const {
+  for (const GrammarJob& job : this->jobs) {
+    if (job.status == "failed") return false;
+  }
+  return true;
+}
@@ -0,0 +1,58 @@
+#ifndef __GRAMMAR_BATCH_HPP__
+#define __GRAMMAR_BATCH_HPP__
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "LL1.hpp"
+
+using namespace std;
+
+// Outcome of compiling one grammar directory
+struct GrammarJob {
+  // directory holding GRAMMAR_FILE_NAME; the generated files go there too
+  string dirPath;
+  // "ok", "up to date" or "failed"
+  string status;
+  // everything the compilation printed (messages, dumps, errors)
+  string log;
+  double milliseconds;
+  // sizes of the compiled grammar and its table (-1 -> not compiled)
+  int numNonTers;
+  int numRules;
+  int numTableEntries;
+  int numConflicts;
+};
+
+// Compiles several grammar directories (shaped like grammar_1/) at once, one
+// directory per thread of a pool. Every grammar gets its own LL1 printing to
+// its own log, so nothing is shared and outputs don't interleave.
+class GrammarBatch {
+  vector<GrammarJob> jobs;
+  // options of every LL1; grammarPath, log and exitOnError are set per job
+  LL1Options options;
+  // regenerate the files even if they are up to date
+  bool force;
+  // name of the stats file written into each directory ("" -> none); the
+  // allocations of a phase include those of grammars compiled meanwhile
+  string statsFileName;
+  // wall clock time of the last run
+  double milliseconds;
+  int numThreads;
+
+  void compileJob(GrammarJob& job) const;
+
+ public:
+  GrammarBatch(const vector<string>& dirPaths, const LL1Options& options,
+               bool force, const string& statsFileName = "");
+  // compiles every directory, numThreads of them at a time
+  void run(int numThreads);
+  // prints the log of every grammar in the order given, then a table of
+  // their timings, sizes and conflicts
+  void printSummary(ostream& out) const;
+  // true if no grammar failed
+  bool succeeded() const;
+};
+
+#endif
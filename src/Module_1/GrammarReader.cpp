@@ -0,0 +1,103 @@
+#include "GrammarReader.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static inline bool isSpace(char c) {
+  return c == ' ' || c == '\n' || c == '\t' || c == '\r' || c == '\v' ||
+         c == '\f';
+}
+
+GrammarReader::GrammarReader(const string& path) {
+  this->path = path;
+  this->data = nullptr;
+  this->size = 0;
+  this->pos = 0;
+  this->isMapped = false;
+  this->lineBegin = 0;
+  this->line = 1;
+  this->tokenLine = 1;
+  this->tokenColumn = 1;
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw string("cannot open " + path);
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) < 0) {
+    close(fd);
+    throw string("cannot read " + path);
+  }
+  this->size = fileStat.st_size;
+  if (this->size > 0) {
+    void* mapping = mmap(nullptr, this->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+      close(fd);
+      throw string("cannot map " + path);
+    }
+    // the scanner only moves forward
+    madvise(mapping, this->size, MADV_SEQUENTIAL);
+    this->data = (const char*)mapping;
+    this->isMapped = true;
+  }
+  close(fd);
+}
+
+GrammarReader::~GrammarReader() {
+  if (this->isMapped) munmap((void*)this->data, this->size);
+}
+
+string_view GrammarReader::next() {
+  const char* data = this->data;
+  size_t size = this->size;
+  size_t pos = this->pos;
+  while (pos < size && isSpace(data[pos])) {
+    if (data[pos] == '\n') {
+      ++this->line;
+      this->lineBegin = pos + 1;
+    }
+    ++pos;
+  }
+  size_t begin = pos;
+  while (pos < size && !isSpace(data[pos])) ++pos;
+  this->pos = pos;
+  this->tokenLine = this->line;
+  this->tokenColumn = begin - this->lineBegin + 1;
+  return string_view(data + begin, pos - begin);
+}
+
+string_view GrammarReader::expectToken(const char* what) {
+  string_view token = this->next();
+  if (token.empty()) {
+    throw this->errorAtToken(string("unexpected end of file, expected ") +
+                             what);
+  }
+  return token;
+}
+
+void GrammarReader::expect(string_view expected) {
+  string_view token = this->next();
+  if (token != expected) {
+    throw this->errorAtToken("expected \"" + string(expected) + "\", found " +
+                             (token.empty() ? string("end of file")
+                                            : "\"" + string(token) + "\""));
+  }
+}
+
+int GrammarReader::nextCount(const char* what) {
+  string_view token = this->expectToken(what);
+  long long value = 0;
+  for (char c : token) {
+    if (c < '0' || c > '9' || value > 1000000000) {
+      throw this->errorAtToken(string("expected ") + what + ", found \"" +
+                               string(token) + "\"");
+    }
+    value = value * 10 + (c - '0');
+  }
+  return value;
+}
+
+string GrammarReader::errorAtToken(const string& message) const {
+  return this->path + ":" + to_string(this->tokenLine) + ":" +
+         to_string(this->tokenColumn) + ": " + message;
+}
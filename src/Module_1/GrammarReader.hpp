@@ -0,0 +1,44 @@
+#ifndef __GRAMMAR_READER_HPP__
+#define __GRAMMAR_READER_HPP__
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+// Whitespace separated tokens of a grammar file.
+//
+// The file is mapped into memory and scanned in place: tokens are views into
+// the mapping, so reading a grammar copies no strings. Every error is thrown
+// as a string of the form "<path>:<line>:<column>: <message>".
+class GrammarReader {
+  string path;
+  const char* data;
+  size_t size;
+  size_t pos;
+  bool isMapped;
+  // position of the first character of the current line
+  size_t lineBegin;
+  int line;
+  // position of the last token returned by next()
+  int tokenLine;
+  int tokenColumn;
+
+ public:
+  // throws if the file can't be read
+  GrammarReader(const string& path);
+  ~GrammarReader();
+  // next token ("" at the end of the file)
+  string_view next();
+  // next token, throws if the file ended
+  string_view expectToken(const char* what);
+  // next token, throws unless it is expected
+  void expect(string_view expected);
+  // next token as a non-negative integer
+  int nextCount(const char* what);
+  // message prefixed with the position of the last token
+  string errorAtToken(const string& message) const;
+};
+
+#endif
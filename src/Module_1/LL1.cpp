@@ -1,585 +1,2108 @@
 #include "LL1.hpp"
 
-LL1::LL1() {
+// Splits nodes into the strongly connected components of the graph given by
+// dependsOn (u depends on every node in dependsOn[u->id]) and groups the
+// components in levels: a component only depends on itself and on components
+// of earlier levels. Uses an iterative Tarjan so deep graphs can't overflow
+// the stack.
+static vector<vector<vector<Symbol*>>> sccLevels(
+    const vector<Symbol*>& nodes, const vector<vector<Symbol*>>& dependsOn) {
+  int numIds = dependsOn.size();
+  vector<int> index(numIds, -1), lowLink(numIds, 0), componentOf(numIds, -1);
+  vector<bool> onStack(numIds, false);
+  vector<Symbol*> tarjanStack;
+  vector<vector<Symbol*>> components;
+  vector<int> componentLevel;
+  int nextIndex = 0;
+
+  // explicit dfs stack of (node, position of the next dependency to visit)
+  vector<pair<Symbol*, int>> dfsStack;
+  for (Symbol* root : nodes) {
+    if (index[root->id] >= 0) continue;
+    dfsStack.push_back({root, 0});
+    while (!dfsStack.empty()) {
+      Symbol* node = dfsStack.back().first;
+      int& nextDep = dfsStack.back().second;
+      if (nextDep == 0) {
+        index[node->id] = lowLink[node->id] = nextIndex++;
+        tarjanStack.push_back(node);
+        onStack[node->id] = true;
+      }
+      const vector<Symbol*>& deps = dependsOn[node->id];
+      if (nextDep < (int)deps.size()) {
+        Symbol* dep = deps[nextDep++];
+        if (index[dep->id] < 0) {
+          dfsStack.push_back({dep, 0});
+        } else if (onStack[dep->id]) {
+          lowLink[node->id] = min(lowLink[node->id], index[dep->id]);
+        }
+        continue;
+      }
+
+      // all dependencies visited: node might be the root of a component
+      if (lowLink[node->id] == index[node->id]) {
+        int componentId = components.size();
+        int level = 0;
+        components.emplace_back();
+        Symbol* member;
+        do {
+          member = tarjanStack.back();
+          tarjanStack.pop_back();
+          onStack[member->id] = false;
+          componentOf[member->id] = componentId;
+          components.back().push_back(member);
+        } while (member != node);
+        // components are completed dependencies first, so the level of every
+        // component this one depends on is already known
+        for (Symbol* m : components.back()) {
+          for (Symbol* dep : dependsOn[m->id]) {
+            int depComponent = componentOf[dep->id];
+            if (depComponent != componentId) {
+              level = max(level, componentLevel[depComponent] + 1);
+            }
+          }
+        }
+        componentLevel.push_back(level);
+      }
+      dfsStack.pop_back();
+      if (!dfsStack.empty()) {
+        Symbol* parent = dfsStack.back().first;
+        lowLink[parent->id] = min(lowLink[parent->id], lowLink[node->id]);
+      }
+    }
+  }
+
+  vector<vector<vector<Symbol*>>> levels;
+  for (int i = 0; i < (int)components.size(); ++i) {
+    if (componentLevel[i] >= (int)levels.size()) {
+      levels.resize(componentLevel[i] + 1);
+    }
+    levels[componentLevel[i]].push_back(move(components[i]));
+  }
+  return levels;
+}
+
+LL1::LL1(const LL1Options& options) {
   this->totNumSyms = 0;
-  // take cfg as an input from the user
-  this->readCFG();
+  this->threadPool = (options.numThreads > 1)
+                         ? new ThreadPool(options.numThreads)
+                         : nullptr;
+  this->expandLeadingNonTers = options.expandLeadingNonTers;
+  this->verbose = options.verbose;
+  this->lookahead = options.lookahead;
+  this->adaptive = options.adaptive;
+  this->minimize = options.minimize;
+  this->log = options.log;
+  this->exitOnError = options.exitOnError;
+  this->collectStats = options.collectStats;
+  if (this->collectStats) countAllocations();
+  this->numIterations = 0;
+  // take cfg as an input from the user (or from the grammar file)
   // fills up: startSymbol, terminals, nonTerminals, and production-rules
-  cout << "\n You entered:\n";
-  this->printCFG();
+  this->runPhase("readGrammar", [&] {
+    if (options.grammarPath == "") {
+      this->readCFG(cin, true);
+    } else {
+      try {
+        this->readCFGFile(options.grammarPath);
+      } catch (string message) {
+        this->fail(message);
+      }
+    }
+  });
+  this->grammarHash = this->hashGrammar();
+}
+
+void LL1::runPhase(const string& name, const function<void()>& phase) {
+  if (!this->collectStats) {
+    phase();
+    return;
+  }
+  PhaseStats stats;
+  stats.name = name;
+  stats.rulesBefore = this->productionRules.size();
+  stats.nonTersBefore = this->nonTerminals.size();
+  stats.symbolsBefore = this->totNumSyms;
+  long rssBefore = peakRssKb();
+  long long allocationsBefore = allocationCount();
+  long long bytesBefore = allocatedBytes();
+  this->numIterations = 0;
+  auto start = chrono::steady_clock::now();
+  // a failing phase is recorded up to where it failed
+  auto record = [&]() {
+    stats.milliseconds = chrono::duration<double, milli>(
+                             chrono::steady_clock::now() - start)
+                             .count();
+    stats.peakRssDeltaKb = peakRssKb() - rssBefore;
+    stats.numAllocations = allocationCount() - allocationsBefore;
+    stats.bytesAllocated = allocatedBytes() - bytesBefore;
+    stats.rulesAfter = this->productionRules.size();
+    stats.nonTersAfter = this->nonTerminals.size();
+    stats.symbolsAfter = this->totNumSyms;
+    stats.numIterations = this->numIterations;
+    this->phaseStats.push_back(stats);
+  };
+  try {
+    phase();
+  } catch (...) {
+    record();
+    throw;
+  }
+  record();
+}
+
+void LL1::fail(const string& message) const {
+  *this->log << "Error: " << message << "\n";
+  if (this->exitOnError) exit(EXIT_FAILURE);
+  throw message;
+}
+
+void LL1::openOutputFile(ofstream& outFile, const string& path) const {
+  outFile.open(path);
+  if (!outFile) this->fail("can't write " + path);
+}
+
+void LL1::closeOutputFile(ofstream& outFile, const string& path) const {
+  outFile.close();
+  if (!outFile) this->fail("can't write " + path);
+}
+
+void LL1::compile(const string& statePath) {
+  if (this->verbose) {
+    *this->log << "\n You entered:\n";
+    this->printCFG();
+  }
 
-  // Nested left recursion is removed, but nested left factors are not
-  // seperated. So, if a grammar has nested left factoring, it will not be
-  // successfully converted to an LL1 grammar.
-  // Example of such grammar
+  // Left factoring factors common prefixes at every depth. Prefixes that only
+  // show up after expanding a leading non-terminal, e.g.
   //    A -> B | abcd
   //    B -> abd
-  //    (In this grammar, effectively A -> abd | abcd, this production-rule has
-  //    a common factor "ab")
-  // In this case, calling buildParseTable method might cause an exception
-  this->eliminateLeftRecursion();
-  this->leftFactor();
-
-  cout << "\n After eliminating left-recursion and factoring the CFG:\n";
-  this->printCFG();
+  //    (effectively A -> abd | abcd, which has a common factor "ab")
+  // are factored only if expandLeadingNonTers is set; otherwise calling
+  // buildParseTable method might cause an exception
+  this->runPhase("eliminateLeftRecursion",
+                 [this] { this->eliminateLeftRecursion(); });
+  this->runPhase("leftFactor", [this] { this->leftFactor(); });
+  if (this->minimize) {
+    this->runPhase("minimizeGrammar", [this] { this->minimizeGrammar(); });
+  }
+  // the rewriting is done: lay the rules out in order of nonTerminals
+  this->productionRules.compact(this->nonTerminals);
 
-  // propagate first and follow sets for all the symbols
-  this->computeFirst();
-  this->computeFollow();
+  if (this->verbose) {
+    *this->log
+        << "\n After eliminating left-recursion and factoring the CFG:\n";
+    this->printCFG();
+  }
 
-  // build a parsing table
   // if the grammar is not LL(1), an exception is thrown by
-  // buildParsingTable method
+  // buildParsingTable method (or while rebuilding a row incrementally); the
+  // state file only holds an LL(1) table, so it is not used with lookahead > 1
+  // or adaptive cells
+  bool hasDecisions = this->lookahead > 1 || this->adaptive;
   try {
-    this->buildParsingTable();
+    bool isCompiled = false;
+    if (statePath != "" && !hasDecisions) {
+      this->runPhase("compileIncrementally", [&] {
+        isCompiled = this->compileIncrementally(statePath);
+      });
+    }
+    if (!isCompiled) {
+      // propagate first and follow sets for all the symbols
+      this->runPhase("computeFirst", [this] { this->computeFirst(); });
+      this->runPhase("computeFollow", [this] { this->computeFollow(); });
+      // settle the conflicting cells by looking further ahead, or leave them
+      // to the parser
+      if (hasDecisions) {
+        this->runPhase("resolveConflicts", [this] {
+          if (this->isLL1()) return;
+          this->decidedCells.assign(this->totNumSyms, SymbolSet());
+          if (this->lookahead > 1) this->buildLookaheadDecisions();
+          if (this->adaptive) this->markAdaptiveCells();
+        });
+      }
+      // build a parsing table
+      this->runPhase("buildParsingTable",
+                     [this] { this->buildParsingTable(); });
+    }
   } catch (string message) {
-    cout << "Error: " << message << "\n";
-    exit(EXIT_FAILURE);
+    // the sets are complete once the table runs into a conflict: list all the
+    // conflicts instead of just the first one
+    if (message == NOT_LL1_EXCEPTION && !this->isLL1()) {
+      this->printConflicts(*this->log);
+    }
+    this->fail(message);
   }
+  if (this->verbose) this->dumpAnalysis();
+}
+
+LL1::~LL1() {
+  delete this->threadPool;
 }
 
-bool LL1::predictiveParsing(const vector<string>& tokens) const {
-  int tokenIndex = 0;
-  stack<Symbol*> st;
-  st.push(this->dollarSymbol);
-  st.push(this->startSymbol);
+int LL1::numNonTerminals() const { return this->nonTerminals.size(); }
 
-  while (!st.empty()) {
-    cout << "Lookup: [" << st.top()->symbol << " " << tokens[tokenIndex]
-         << "]\n";
-    Symbol* stackTop = st.top();
-    if (this->symToPtr.find(tokens[tokenIndex]) == this->symToPtr.end()) {
-      cout << "Unexpected symbol: " << tokens[tokenIndex] << "\n";
-      return false;
+int LL1::numProductionRules() const { return this->productionRules.size(); }
+
+int LL1::numTableEntries() const {
+  int numEntries = 0;
+  for (const auto& row : this->parsingTable) numEntries += row.size();
+  return numEntries;
+}
+
+int LL1::numConflicts() const {
+  return this->conflicts.size() + this->adaptiveCells.size();
+}
+
+Symbol* LL1::addSymbol(string_view name, bool isTerminal) {
+  this->totNumSyms++;
+  return this->symbolTable.add(name, isTerminal);
+}
+
+string LL1::addRhsToken(Symbol* lhs, vector<RhsGroup>& groups,
+                        string_view token) {
+  RhsGroup& group = groups.back();
+  if (token == PRODUCTION_RULE_OR) {
+    group.alternatives.emplace_back();
+    return "";
+  }
+  if (token == EBNF_REPEAT_BEGIN || token == EBNF_OPTIONAL_BEGIN) {
+    groups.push_back({string(token), {{}}});
+    return "";
+  }
+  if (token == EBNF_REPEAT_END || token == EBNF_OPTIONAL_END) {
+    const string& opener = (token == EBNF_REPEAT_END) ? EBNF_REPEAT_BEGIN
+                                                      : EBNF_OPTIONAL_BEGIN;
+    if (group.opener != opener) {
+      return "\"" + string(token) + "\" does not close \"" + group.opener +
+             "\"";
     }
-    Symbol* tokenPtr = this->symToPtr.find(tokens[tokenIndex])->second;
-    if (!tokenPtr->isTerminal || tokenPtr == this->epsSymbol) {
-      cout << "Unexpected symbol: " << tokens[tokenIndex] << "\n";
-      return false;
+    for (const vector<Symbol*>& alternative : group.alternatives) {
+      if (alternative.empty()) return "empty alternative in an EBNF group";
     }
+    Symbol* groupSym = this->addEbnfGroup(lhs, group);
+    groups.pop_back();
+    groups.back().alternatives.back().push_back(groupSym);
+    return "";
+  }
+  Symbol* sym = this->symbolTable.find(token);
+  if (sym == nullptr) return "unknown symbol \"" + string(token) + "\"";
+  group.alternatives.back().push_back(sym);
+  return "";
+}
 
-    if (stackTop->isTerminal && stackTop->symbol == tokens[tokenIndex]) {
-      st.pop();
-      tokenIndex++;
-      cout << "Match found: " << stackTop->symbol << "\nStack: " << st
-           << "\nRemaining-I/p: "
-           << make_pair(tokens, make_pair(tokenIndex, tokens.size())) << "\n";
-      if (tokenIndex == tokens.size()) {
-        return (st.size() == 0);
-      }
-    } else if (stackTop->isTerminal) {
-      cout << "Expected: " << stackTop->symbol
-           << " Found: " << tokens[tokenIndex] << "\n";
-      return false;
-    } else {
-      if (this->parsingTable.find(stackTop) == this->parsingTable.end()) {
-        cout << "No production rule can be applied!\n";
-        return false;
-      }
-      auto symParseRow = this->parsingTable.find(stackTop)->second;
-      if (symParseRow.find(tokenPtr) == symParseRow.end()) {
-        cout << "No production rule can be applied!\n";
-        return false;
-      }
-      ProductionRule* pr = symParseRow.find(tokenPtr)->second;
-      st.pop();
-      for (auto it = pr->rhs.rbegin(); it != pr->rhs.rend(); ++it) {
-        if ((*it) == this->epsSymbol) continue;
-        st.push(*it);
+Symbol* LL1::addEbnfGroup(Symbol* lhs, const RhsGroup& group) {
+  // G -> [ alternative G ] for each alternative, or just G -> [ alternative ]
+  // if the group is optional, plus G -> [ ε ]
+  bool isRepeated = (group.opener == EBNF_REPEAT_BEGIN);
+  string baseName = string(lhs->name()) + (isRepeated ? "_*" : "_?");
+  string name = baseName;
+  for (int n = 2; this->symbolTable.find(name) != nullptr; ++n) {
+    name = baseName + to_string(n);
+  }
+  Symbol* groupSym = this->addSymbol(name, false);
+  this->nonTerminals.push_back(groupSym);
+  for (vector<Symbol*> rhs : group.alternatives) {
+    if (isRepeated) rhs.push_back(groupSym);
+    this->productionRules.add(groupSym, move(rhs));
+  }
+  vector<Symbol*> epsRhs{this->epsSymbol};
+  this->productionRules.add(groupSym, epsRhs);
+  return groupSym;
+}
+
+vector<Symbol*> LL1::loopNonTerminals() const {
+  vector<Symbol*> loops;
+  for (Symbol* nonTer : this->nonTerminals) {
+    bool isLoop = true, iterates = false;
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      int uses = count(pr->rhs.begin(), pr->rhs.end(), nonTer);
+      bool endsWithNonTer = pr->rhs.size() > 1 && pr->rhs.back() == nonTer;
+      isLoop &= (uses == 0 || (uses == 1 && endsWithNonTer));
+      iterates |= endsWithNonTer;
+    }
+    if (isLoop && iterates) loops.push_back(nonTer);
+  }
+  return loops;
+}
+
+bool LL1::firstOfRule(const ProductionRule* pr, SymbolSet& firstOfRhs) const {
+  int epsId = this->epsSymbol->id;
+  for (Symbol* rhsSym : pr->rhs) {
+    const SymbolSet& rhsFirst = this->firstSets[rhsSym->id];
+    firstOfRhs.unionWith(rhsFirst, epsId);
+    if (!rhsFirst.contains(epsId)) return false;
+  }
+  return true;
+}
+
+void LL1::findConflictsInRow(Symbol* nonTer,
+                             vector<LL1Conflict>& found) const {
+  RuleRange prs = this->productionRules.rulesOf(nonTer);
+  vector<SymbolSet> firstOfRhs(prs.size()), predicts(prs.size());
+  // seen: union of the predict sets so far; clashing: symbols in two or more
+  // of them, all computed a word at a time
+  SymbolSet seen, clashing, seenFirst, clashingFirst;
+  for (int k = 0; k < prs.size(); ++k) {
+    bool isEps = this->firstOfRule(prs[k], firstOfRhs[k]);
+    predicts[k].unionWith(firstOfRhs[k]);
+    if (isEps) predicts[k].unionWith(this->followSets[nonTer->id]);
+    clashing.unionWithCommon(seen, predicts[k]);
+    seen.unionWith(predicts[k]);
+    clashingFirst.unionWithCommon(seenFirst, firstOfRhs[k]);
+    seenFirst.unionWith(firstOfRhs[k]);
+  }
+  clashing.forEach([&](int ipSymId) {
+    LL1Conflict conflict;
+    conflict.nonTer = nonTer;
+    conflict.ipSym = this->symbolTable.at(ipSymId);
+    conflict.isFirstFirst = clashingFirst.contains(ipSymId);
+    for (int k = 0; k < prs.size(); ++k) {
+      if (predicts[k].contains(ipSymId)) conflict.rules.push_back(prs[k]);
+    }
+    found.push_back(conflict);
+  });
+}
+
+bool LL1::isLL1() {
+  this->conflicts.clear();
+  if (this->threadPool == nullptr) {
+    for (Symbol* nonTer : this->nonTerminals) {
+      this->findConflictsInRow(nonTer, this->conflicts);
+    }
+  } else {
+    vector<vector<LL1Conflict>> found(this->nonTerminals.size());
+    this->threadPool->parallelFor(this->nonTerminals.size(), [&](int i) {
+      this->findConflictsInRow(this->nonTerminals[i], found[i]);
+    });
+    for (const auto& rowConflicts : found) {
+      this->conflicts.insert(this->conflicts.end(), rowConflicts.begin(),
+                             rowConflicts.end());
+    }
+  }
+  return this->conflicts.empty();
+}
+
+void LL1::printConflicts(ostream& out) const {
+  for (const LL1Conflict& conflict : this->conflicts) {
+    out << "Conflict: ( " << conflict.nonTer->name() << ", "
+        << conflict.ipSym->name() << " ) "
+        << (conflict.isFirstFirst ? "FIRST/FIRST" : "FIRST/FOLLOW");
+    for (int k = 0; k < (int)conflict.rules.size(); ++k) {
+      out << (k == 0 ? ": " : "| ") << conflict.rules[k];
+    }
+    out << "\n";
+  }
+}
+
+LookaheadTrie LL1::firstKOfString(const vector<Symbol*>& syms, int from,
+                                  const vector<LookaheadTrie>& firstK) const {
+  int dollarId = this->dollarSymbol->id;
+  LookaheadTrie result;
+  result.insert({});
+  // once every string is k long the rest of syms can't change anything
+  for (int i = from; i < (int)syms.size() &&
+                     result.hasOpenString(this->lookahead, dollarId);
+       ++i) {
+    result = result.concat(firstK[syms[i]->id], this->lookahead, dollarId);
+  }
+  return result;
+}
+
+void LL1::computeFirstK(vector<LookaheadTrie>& firstK) const {
+  firstK.assign(this->totNumSyms, LookaheadTrie());
+  firstK[this->epsSymbol->id].insert({});
+  firstK[this->dollarSymbol->id].insert({this->dollarSymbol->id});
+  for (Symbol* ter : this->terminals) firstK[ter->id].insert({ter->id});
+
+  // same worklist as computeFirstFixedPoint: sets only grow and hold strings
+  // of at most k terminals, so this terminates
+  vector<vector<Symbol*>> users = this->firstUsers();
+  deque<Symbol*> worklist(this->nonTerminals.begin(),
+                          this->nonTerminals.end());
+  vector<bool> inWorklist(this->totNumSyms, false);
+  for (Symbol* nonTer : this->nonTerminals) inWorklist[nonTer->id] = true;
+  while (!worklist.empty()) {
+    Symbol* nonTer = worklist.front();
+    worklist.pop_front();
+    inWorklist[nonTer->id] = false;
+    ++this->numIterations;
+    bool didGrow = false;
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      didGrow |= firstK[nonTer->id].unionWith(
+          this->firstKOfString(pr->rhs, 0, firstK));
+    }
+    if (!didGrow) continue;
+    for (Symbol* user : users[nonTer->id]) {
+      if (!inWorklist[user->id]) {
+        inWorklist[user->id] = true;
+        worklist.push_back(user);
       }
-      cout << "Applying production rule: " << pr << "\nStack: " << st
-           << "\nRemaining-I/p: "
-           << make_pair(tokens, make_pair(tokenIndex, tokens.size())) << "\n";
     }
-    cout << "===\n";
   }
+}
 
-  return false;
+void LL1::computeFollowK(const vector<LookaheadTrie>& firstK,
+                         vector<LookaheadTrie>& followK) const {
+  int dollarId = this->dollarSymbol->id;
+  followK.assign(this->totNumSyms, LookaheadTrie());
+  followK[this->startSymbol->id].insert({dollarId});
+
+  // FIRST_k of what follows each rhs non-terminal doesn't change between
+  // rounds, only the follow set of the lhs it is concatenated with does
+  vector<tuple<Symbol*, Symbol*, LookaheadTrie>> constraints;
+  for (const ProductionRule* pr : this->productionRules.allRules()) {
+    for (int i = 0; i < (int)pr->rhs.size(); ++i) {
+      if (pr->rhs[i]->isTerminal || pr->rhs[i] == this->epsSymbol) continue;
+      constraints.emplace_back(pr->rhs[i], pr->lhs,
+                               this->firstKOfString(pr->rhs, i + 1, firstK));
+    }
+  }
+  bool didGrow = true;
+  while (didGrow) {
+    didGrow = false;
+    ++this->numIterations;
+    for (const auto& constraint : constraints) {
+      const auto& [rhsSym, lhsSym, rest] = constraint;
+      LookaheadTrie follow =
+          rest.concat(followK[lhsSym->id], this->lookahead, dollarId);
+      didGrow |= followK[rhsSym->id].unionWith(follow);
+    }
+  }
 }
 
-void LL1::buildParsingTable() {
-  auto& ll1ParsingTable = this->parsingTable;
-  this->parsingTable.clear();
-  for (const auto& symPr : this->productionRules) {
-    for (ProductionRule* pr : symPr.second) {
-      bool isEps = false;
-      Symbol* activeSymbol = pr->lhs;
-      for (Symbol* rhsSym : pr->rhs) {
-        // iterate first(rhsSym)
-        for (Symbol* firstRhsSym : this->firstSetsMap[rhsSym]) {
-          if (firstRhsSym == this->epsSymbol) {
-            isEps = true;
-            continue;
-          }
-          // if there is already a rule in
-          // ParsingTable[activeSymbol][firstRhsSym] -> throw an exception
-          if (ll1ParsingTable.find(activeSymbol) != ll1ParsingTable.end() &&
-              ll1ParsingTable[activeSymbol].find(firstRhsSym) !=
-                  ll1ParsingTable[activeSymbol].end()) {
-            throw NOT_LL1_EXCEPTION;
-          }
-          parsingTable[activeSymbol][firstRhsSym] = pr;
+void LL1::buildLookaheadDecisions() {
+  vector<LookaheadTrie> firstK, followK;
+  this->computeFirstK(firstK);
+  this->computeFollowK(firstK, followK);
+  int dollarId = this->dollarSymbol->id;
+
+  this->decisions.clear();
+  vector<LL1Conflict> unresolved;
+  for (const LL1Conflict& conflict : this->conflicts) {
+    // lookahead strings starting with ipSym -> rules predicted by them
+    map<vector<int>, vector<int>> predictedBy;
+    for (int r = 0; r < (int)conflict.rules.size(); ++r) {
+      const ProductionRule* pr = conflict.rules[r];
+      LookaheadTrie predict =
+          this->firstKOfString(pr->rhs, 0, firstK)
+              .concat(followK[pr->lhs->id], this->lookahead, dollarId);
+      predict.forEach([&](const vector<int>& str) {
+        if (str.empty() || str[0] != conflict.ipSym->id) return;
+        // every prefix, so that the shortest distinguishing one is found
+        for (int len = 1; len <= (int)str.size(); ++len) {
+          vector<int>& rules = predictedBy[vector<int>(str.begin(),
+                                                       str.begin() + len)];
+          if (rules.empty() || rules.back() != r) rules.push_back(r);
         }
-        if (!isEps) break;
-      }
-      // if first(rhs) has eps
-      if (isEps) {
-        // add prodution-rule for all the input symbols in Follow(pr->lhs)
-        for (Symbol* followSym : this->followSetsMap[activeSymbol]) {
-          // if there is already a rule in
-          // ParsingTable[activeSymbol][followSym] -> throw an exception
-          if (ll1ParsingTable.find(activeSymbol) != ll1ParsingTable.end() &&
-              ll1ParsingTable[activeSymbol].find(followSym) !=
-                  ll1ParsingTable[activeSymbol].end()) {
-            throw NOT_LL1_EXCEPTION;
-          }
-          parsingTable[activeSymbol][followSym] = pr;
+      });
+    }
+
+    // strings are k long or end with $, so none is a proper prefix of
+    // another: two rules sharing a complete string are a real conflict
+    LLkDecision decision;
+    decision.nonTer = conflict.nonTer;
+    decision.ipSym = conflict.ipSym;
+    bool isResolved = true;
+    for (const auto& [str, rules] : predictedBy) {
+      if (rules.size() == 1) {
+        vector<int> parent(str.begin(), str.end() - 1);
+        if (str.size() == 1 || predictedBy.at(parent).size() > 1) {
+          vector<Symbol*> syms;
+          for (int id : str) syms.push_back(this->symbolTable.at(id));
+          decision.alternatives.push_back(
+              {syms, conflict.rules[rules[0]]});
         }
+      } else if ((int)str.size() == this->lookahead ||
+                 str.back() == dollarId) {
+        isResolved = false;
       }
     }
+    if (!isResolved) {
+      unresolved.push_back(conflict);
+      continue;
+    }
+    this->decidedCells[conflict.nonTer->id].insert(conflict.ipSym->id);
+    this->decisions.push_back(move(decision));
   }
 
-  // print parsing table
-  cout << "Parsing Table\n";
-  for (const auto& nonTerEntry : this->parsingTable) {
-    for (const auto& ipSymEntry : nonTerEntry.second) {
-      // ipSymEntry.second
-      cout << "( " << nonTerEntry.first->symbol << ", "
-           << ipSymEntry.first->symbol << ") -> ";
-      cout << ipSymEntry.second->lhs->symbol << " -> [ ";
-      for (Symbol* rhsSym : ipSymEntry.second->rhs) {
-        cout << rhsSym->symbol << " ";
-      }
-      cout << "]\n";
-    }
+  this->conflicts = move(unresolved);
+  if (!this->conflicts.empty() && !this->adaptive) {
+    this->printConflicts(*this->log);
+    throw NOT_LLK_EXCEPTION;
   }
 }
 
-void LL1::computeFirstForSym(Symbol* sym) {
-  if (this->firstSetsMap.find(sym) != firstSetsMap.end()) {
-    return;
+void LL1::markAdaptiveCells() {
+  for (const LL1Conflict& conflict : this->conflicts) {
+    this->decidedCells[conflict.nonTer->id].insert(conflict.ipSym->id);
   }
+  this->adaptiveCells = move(this->conflicts);
+  this->conflicts.clear();
+}
 
-  auto& firstSet = this->firstSetsMap[sym];
+void LL1::buildParsingTableRow(Symbol* nonTer,
+                               vector<pair<Symbol*, ProductionRule*>>& row) {
+  // terminals that already have a rule in this row
+  SymbolSet filled;
+  for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+    // predict set of the rule: first(rhs), plus Follow(pr->lhs) if rhs
+    // derives eps
+    SymbolSet predict;
+    if (this->firstOfRule(pr, predict)) {
+      predict.unionWith(this->followSets[nonTer->id]);
+    }
+    // cells settled by an LL(k) decision stay empty
+    if (nonTer->id < (int)this->decidedCells.size()) {
+      predict.subtract(this->decidedCells[nonTer->id]);
+    }
+    // if there is already a rule in ParsingTable[nonTer][ipSym] for some
+    // ipSym of the predict set -> throw an exception
+    if (filled.intersects(predict)) {
+      throw NOT_LL1_EXCEPTION;
+    }
+    filled.unionWith(predict);
+    predict.forEach([&](int ipSymId) {
+      row.push_back({this->symbolTable.at(ipSymId), pr});
+    });
+  }
+  sort(row.begin(), row.end(),
+       [](const pair<Symbol*, ProductionRule*>& a,
+          const pair<Symbol*, ProductionRule*>& b) {
+         return a.first->id < b.first->id;
+       });
+}
 
-  if (sym->isTerminal) {
-    firstSet.insert(sym);
-    return;
+void LL1::buildParsingTable() {
+  this->parsingTable.assign(this->totNumSyms, {});
+  if (this->threadPool == nullptr) {
+    for (Symbol* nonTer : this->nonTerminals) {
+      this->buildParsingTableRow(nonTer, this->parsingTable[nonTer->id]);
+    }
+  } else {
+    // rows only read first/follow sets and write their own row, so all the
+    // rows are filled concurrently
+    this->threadPool->parallelFor(this->nonTerminals.size(), [this](int i) {
+      Symbol* nonTer = this->nonTerminals[i];
+      this->buildParsingTableRow(nonTer, this->parsingTable[nonTer->id]);
+    });
   }
+}
 
-  // for non-terminals -> iterate over each production rule
-  for (ProductionRule* pr : this->productionRules[sym]) {
-    bool isEps = false;
-    // compute first of the first sym on RHS
-    // if it contains eps -> compute first of the next sym and so on...
-    for (Symbol* rhsSym : pr->rhs) {
-      this->computeFirstForSym(rhsSym);
+ProductionRule* LL1::parsingTableEntry(const Symbol* nonTer,
+                                       const Symbol* ipSym) const {
+  if (nonTer->id >= (int)this->parsingTable.size()) return nullptr;
+  const auto& row = this->parsingTable[nonTer->id];
+  auto cell = lower_bound(
+      row.begin(), row.end(), ipSym->id,
+      [](const pair<Symbol*, ProductionRule*>& entry, int ipSymId) {
+        return entry.first->id < ipSymId;
+      });
+  if (cell == row.end() || cell->first != ipSym) return nullptr;
+  return cell->second;
+}
 
-      const auto& rhsFirstSet = this->firstSetsMap[rhsSym];
-      for (Symbol* rhsFirstSym : rhsFirstSet) {
-        firstSet.insert(rhsFirstSym);
-      }
-      isEps = (rhsFirstSet.find(epsSymbol) != rhsFirstSet.end());
+bool LL1::computeFirstForSym(Symbol* sym) {
+  int epsId = this->epsSymbol->id;
+  SymbolSet& firstSet = this->firstSets[sym->id];
+  bool didGrow = false;
+
+  // iterate over each production rule of the non-terminal and add whatever
+  // the rule currently contributes; the sets of the rhs symbols may still be
+  // incomplete, the caller re-runs this till nothing changes
+  for (ProductionRule* pr : this->productionRules.rulesOf(sym)) {
+    bool isEps = true;
+    // add first of the first sym on RHS
+    // if it contains eps -> add first of the next sym and so on...
+    for (Symbol* rhsSym : pr->rhs) {
+      const SymbolSet& rhsFirstSet = this->firstSets[rhsSym->id];
+      didGrow |= firstSet.unionWith(rhsFirstSet, epsId);
+      isEps = rhsFirstSet.contains(epsId);
       if (!isEps) {
         break;
       }
     }
     if (isEps) {
-      firstSet.insert(this->epsSymbol);
+      didGrow |= firstSet.insert(epsId);
+    }
+  }
+  return didGrow;
+}
+
+void LL1::computeFirstFixedPoint(const vector<Symbol*>& nonTers,
+                                 const vector<vector<Symbol*>>& users,
+                                 const vector<int>& componentOf,
+                                 int component) {
+  // Fixed point over an explicit worklist: whenever first of a non-terminal
+  // grows, every user of it (within the component) is queued again. Sets only
+  // grow and are bounded by the number of terminals, so this terminates even
+  // on cyclic (mutually recursive, nullable) grammars and never recurses.
+  deque<Symbol*> worklist(nonTers.begin(), nonTers.end());
+  unordered_set<Symbol*> inWorklist(nonTers.begin(), nonTers.end());
+  while (!worklist.empty()) {
+    Symbol* nonTer = worklist.front();
+    worklist.pop_front();
+    inWorklist.erase(nonTer);
+    ++this->numIterations;
+    if (!this->computeFirstForSym(nonTer)) continue;
+    for (Symbol* user : users[nonTer->id]) {
+      if (componentOf[user->id] == component &&
+          inWorklist.insert(user).second) {
+        worklist.push_back(user);
+      }
     }
   }
 }
 
+vector<vector<Symbol*>> LL1::firstUsers() const {
+  vector<vector<Symbol*>> users(this->totNumSyms);
+  // lastUser[B->id] = last non-terminal added to users[B->id]
+  vector<Symbol*> lastUser(this->totNumSyms, nullptr);
+  for (Symbol* nonTer : this->nonTerminals) {
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      for (Symbol* rhsSym : pr->rhs) {
+        if (!rhsSym->isTerminal && lastUser[rhsSym->id] != nonTer) {
+          users[rhsSym->id].push_back(nonTer);
+          lastUser[rhsSym->id] = nonTer;
+        }
+      }
+    }
+  }
+  return users;
+}
+
 void LL1::computeFirst() {
-  cout << "First-sets: \n";
+  this->firstSets.assign(this->totNumSyms, SymbolSet());
+
+  // first of a terminal is the terminal itself
+  this->firstSets[this->epsSymbol->id].insert(this->epsSymbol->id);
   for (Symbol* ter : this->terminals) {
-    this->computeFirstForSym(ter);
-    cout << ter->symbol << ": [ ";
-    for (Symbol* sym : this->firstSetsMap[ter]) {
-      cout << sym->symbol << " ";
+    this->firstSets[ter->id].insert(ter->id);
+  }
+
+  vector<vector<Symbol*>> users = this->firstUsers();
+
+  if (this->threadPool == nullptr) {
+    vector<int> componentOf(this->totNumSyms, 0);
+    this->computeFirstFixedPoint(this->nonTerminals, users, componentOf, 0);
+  } else {
+    // first(A) only depends on first of the non-terminals on the rhs of A's
+    // rules: a component of that graph is complete once the components it
+    // depends on are, so all the components of one level run concurrently
+    vector<vector<Symbol*>> dependsOn(this->totNumSyms);
+    for (Symbol* nonTer : this->nonTerminals) {
+      for (Symbol* user : users[nonTer->id]) {
+        dependsOn[user->id].push_back(nonTer);
+      }
+    }
+    vector<int> componentOf(this->totNumSyms, -1);
+    int numComponents = 0;
+    for (const auto& level : sccLevels(this->nonTerminals, dependsOn)) {
+      int firstComponent = numComponents;
+      for (const auto& component : level) {
+        for (Symbol* member : component) {
+          componentOf[member->id] = numComponents;
+        }
+        ++numComponents;
+      }
+      this->threadPool->parallelFor(level.size(), [&](int i) {
+        this->computeFirstFixedPoint(level[i], users, componentOf,
+                                     firstComponent + i);
+      });
+    }
+  }
+}
+
+// Everything a state file (see createStateFile) holds, by symbol name. The
+// names point into the mapped file, so the reader must outlive this.
+struct CompiledState {
+  vector<string_view> terminals;
+  string_view epsSymbol, dollarSymbol, startSymbol;
+  unordered_set<string_view> nonTerminals;
+  unordered_map<string_view, vector<vector<string_view>>> rules;
+  unordered_map<string_view, vector<string_view>> firstSets;
+  unordered_map<string_view, vector<string_view>> followSets;
+  // rows[non-terminal] = [(input symbol, rhs of the rule)]
+  unordered_map<string_view, vector<pair<string_view, vector<string_view>>>>
+      rows;
+};
+
+// reads "[ a b ... ]" into syms
+static void readBracketedSymbols(GrammarReader& reader,
+                                 vector<string_view>& syms) {
+  reader.expect("[");
+  for (string_view sym = reader.expectToken("\"]\""); sym != "]";
+       sym = reader.expectToken("\"]\"")) {
+    syms.push_back(sym);
+  }
+}
+
+// reads "X -> [ ... ]" lines till endTag
+static void readSymbolSets(
+    GrammarReader& reader, const char* endTag,
+    unordered_map<string_view, vector<string_view>>& sets) {
+  for (string_view sym = reader.expectToken(endTag); sym != endTag;
+       sym = reader.expectToken(endTag)) {
+    reader.expect("->");
+    readBracketedSymbols(reader, sets[sym]);
+  }
+}
+
+static void readCompiledState(GrammarReader& reader, CompiledState& state) {
+  reader.expect("===LL1-state-begin:");
+  reader.expect(GENERATOR_VERSION);
+
+  reader.expect("===LL1-grammar-begin:");
+  reader.expect("Terminals:");
+  for (int i = reader.nextCount("number of terminals"); i > 0; --i) {
+    state.terminals.push_back(reader.expectToken("a terminal"));
+  }
+  reader.expect("Non-terminals:");
+  for (int i = reader.nextCount("number of non-terminals"); i > 0; --i) {
+    state.nonTerminals.insert(reader.expectToken("a non-terminal"));
+  }
+  reader.expect("Eps-symbol:");
+  state.epsSymbol = reader.expectToken("the epsilon symbol");
+  reader.expect("Dollar-symbol:");
+  state.dollarSymbol = reader.expectToken("the dollar symbol");
+  reader.expect("Start-symbol:");
+  state.startSymbol = reader.expectToken("the start symbol");
+  reader.expect("===Production-rules-begin:");
+  for (int i = reader.nextCount("number of production rules"); i > 0; --i) {
+    auto& rulesOfLhs = state.rules[reader.expectToken("a production rule")];
+    reader.expect("->");
+    rulesOfLhs.emplace_back();
+    readBracketedSymbols(reader, rulesOfLhs.back());
+  }
+  reader.expect("===Production-rules-end");
+  reader.expect("===LL1-grammar-end");
+
+  reader.expect("===First-sets-begin:");
+  readSymbolSets(reader, "===First-sets-end", state.firstSets);
+  reader.expect("===Follow-sets-begin:");
+  readSymbolSets(reader, "===Follow-sets-end", state.followSets);
+
+  reader.expect("===Parse-table-begin:");
+  for (int i = reader.nextCount("number of parse table entries"); i > 0; --i) {
+    reader.expect("Parse[");
+    string_view nonTer = reader.expectToken("a non-terminal");
+    string_view ipSym = reader.expectToken("an input symbol");
+    reader.expect("]");
+    reader.expect(":");
+    reader.expectToken("a production rule");
+    reader.expect("->");
+    auto& row = state.rows[nonTer];
+    row.push_back({ipSym, {}});
+    readBracketedSymbols(reader, row.back().second);
+  }
+  reader.expect("===Parse-table-end");
+  reader.expect("===LL1-state-end");
+}
+
+bool LL1::compileIncrementally(const string& statePath) {
+  CompiledState old;
+  unique_ptr<GrammarReader> reader;
+  try {
+    reader.reset(new GrammarReader(statePath));
+    readCompiledState(*reader, old);
+  } catch (string message) {
+    if (this->verbose) *this->log << "Full compilation: " << message << "\n";
+    return false;
+  }
+  // symbol ids (and so the order of the sets and the table) only match if the
+  // terminals are the same
+  bool sameSymbols = old.terminals.size() == this->terminals.size() &&
+                     old.epsSymbol == this->epsSymbol->name() &&
+                     old.dollarSymbol == this->dollarSymbol->name() &&
+                     old.startSymbol == this->startSymbol->name();
+  for (int i = 0; sameSymbols && i < (int)this->terminals.size(); ++i) {
+    sameSymbols = (old.terminals[i] == this->terminals[i]->name());
+  }
+  if (!sameSymbols) {
+    if (this->verbose) {
+      *this->log << "Full compilation: the terminals changed\n";
     }
-    cout << "]\n";
+    return false;
   }
+
+  int numSyms = this->totNumSyms;
+  int epsId = this->epsSymbol->id;
+  // set of the named symbols, false if one of them doesn't exist anymore
+  auto toSymbolSet = [&](const unordered_map<string_view, vector<string_view>>&
+                             sets,
+                         Symbol* sym, SymbolSet& set) {
+    auto it = sets.find(sym->name());
+    if (it == sets.end()) return true;
+    for (string_view name : it->second) {
+      Symbol* member = this->symbolTable.find(name);
+      if (member == nullptr) return false;
+      set.insert(member->id);
+    }
+    return true;
+  };
+  auto sameRhs = [](const vector<Symbol*>& rhs,
+                    const vector<string_view>& names) {
+    if (rhs.size() != names.size()) return false;
+    for (int k = 0; k < (int)rhs.size(); ++k) {
+      if (rhs[k]->name() != names[k]) return false;
+    }
+    return true;
+  };
+  static const vector<vector<string_view>> noRules;
+
+  // 1. non-terminals whose (rewritten) rules are not the ones saved
+  vector<bool> rulesChanged(numSyms, false);
+  vector<Symbol*> changedNonTers;
   for (Symbol* nonTer : this->nonTerminals) {
-    this->computeFirstForSym(nonTer);
-    cout << nonTer->symbol << ": [ ";
-    for (Symbol* sym : this->firstSetsMap[nonTer]) {
-      cout << sym->symbol << " ";
+    auto it = old.rules.find(nonTer->name());
+    const auto& oldRules = (it != old.rules.end()) ? it->second : noRules;
+    RuleRange prs = this->productionRules.rulesOf(nonTer);
+    bool same = old.nonTerminals.count(nonTer->name()) > 0 &&
+                prs.size() == (int)oldRules.size();
+    for (int k = 0; same && k < prs.size(); ++k) {
+      same = sameRhs(prs[k]->rhs, oldRules[k]);
+    }
+    if (!same) {
+      rulesChanged[nonTer->id] = true;
+      changedNonTers.push_back(nonTer);
     }
-    cout << "]\n";
+  }
+
+  // 2. first: only the changed non-terminals and their (transitive) users can
+  // get a different set; everything else keeps the saved one
+  vector<vector<Symbol*>> users = this->firstUsers();
+  vector<bool> firstAffected(numSyms, false);
+  vector<Symbol*> firstWork(changedNonTers);
+  for (Symbol* nonTer : firstWork) firstAffected[nonTer->id] = true;
+  for (int k = 0; k < (int)firstWork.size(); ++k) {
+    for (Symbol* user : users[firstWork[k]->id]) {
+      if (!firstAffected[user->id]) {
+        firstAffected[user->id] = true;
+        firstWork.push_back(user);
+      }
+    }
+  }
+  this->firstSets.assign(numSyms, SymbolSet());
+  this->firstSets[epsId].insert(epsId);
+  for (Symbol* ter : this->terminals) {
+    this->firstSets[ter->id].insert(ter->id);
+  }
+  for (Symbol* nonTer : this->nonTerminals) {
+    if (firstAffected[nonTer->id]) continue;
+    if (!toSymbolSet(old.firstSets, nonTer, this->firstSets[nonTer->id])) {
+      return false;
+    }
+  }
+  vector<int> componentOf(numSyms, 0);
+  this->computeFirstFixedPoint(firstWork, users, componentOf, 0);
+  vector<bool> firstChanged(numSyms, false);
+  for (Symbol* nonTer : firstWork) {
+    SymbolSet oldSet;
+    firstChanged[nonTer->id] =
+        !toSymbolSet(old.firstSets, nonTer, oldSet) ||
+        !(oldSet == this->firstSets[nonTer->id]);
+  }
+
+  // 3. follow: tails[X->id] = non-terminals at the end of a rule of X, only
+  // followed by nullable symbols (they contain Follow(X))
+  vector<vector<Symbol*>> tails(numSyms);
+  for (Symbol* nonTer : this->nonTerminals) {
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      for (int k = (int)pr->rhs.size() - 1; k >= 0; --k) {
+        Symbol* rhsSym = pr->rhs[k];
+        if (rhsSym == this->epsSymbol) continue;
+        if (!rhsSym->isTerminal) tails[nonTer->id].push_back(rhsSym);
+        if (!this->firstSets[rhsSym->id].contains(epsId)) break;
+      }
+    }
+  }
+  // a follow set can change if a rule it gets symbols from changed (or went
+  // away), if first of a symbol after it changed, or if it contains the
+  // follow set of a non-terminal whose follow set can change
+  vector<bool> followAffected(numSyms, false);
+  vector<Symbol*> followWork;
+  auto markFollow = [&](Symbol* sym) {
+    if (sym != nullptr && !sym->isTerminal && !followAffected[sym->id]) {
+      followAffected[sym->id] = true;
+      followWork.push_back(sym);
+    }
+  };
+  for (Symbol* nonTer : changedNonTers) {
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      for (Symbol* rhsSym : pr->rhs) markFollow(rhsSym);
+    }
+    auto it = old.rules.find(nonTer->name());
+    if (it == old.rules.end()) continue;
+    for (const auto& oldRhs : it->second) {
+      for (string_view name : oldRhs) markFollow(this->symbolTable.find(name));
+    }
+  }
+  for (const ProductionRule* pr : this->productionRules.allRules()) {
+    int lastChanged = -1;
+    for (int k = 0; k < (int)pr->rhs.size(); ++k) {
+      if (firstChanged[pr->rhs[k]->id]) lastChanged = k;
+    }
+    for (int k = 0; k < lastChanged; ++k) markFollow(pr->rhs[k]);
+  }
+  for (int k = 0; k < (int)followWork.size(); ++k) {
+    for (Symbol* tail : tails[followWork[k]->id]) markFollow(tail);
+  }
+
+  // recompute the affected sets: what their rules contribute directly, then
+  // what flows in from the follow sets they contain
+  this->followSets.assign(numSyms, SymbolSet());
+  for (Symbol* nonTer : this->nonTerminals) {
+    if (followAffected[nonTer->id]) continue;
+    if (!toSymbolSet(old.followSets, nonTer, this->followSets[nonTer->id])) {
+      return false;
+    }
+  }
+  if (followAffected[this->startSymbol->id]) {
+    this->followSets[this->startSymbol->id].insert(this->dollarSymbol->id);
+  }
+  vector<vector<Symbol*>> unusedDependents(numSyms);
+  for (const ProductionRule* pr : this->productionRules.allRules()) {
+    bool hasAffected = false;
+    for (Symbol* rhsSym : pr->rhs) hasAffected |= followAffected[rhsSym->id];
+    // rules add nothing to an unaffected set it doesn't already have
+    if (hasAffected) {
+      this->computeFollowOfRule(pr, this->followSets, unusedDependents);
+    }
+  }
+  deque<Symbol*> worklist;
+  vector<bool> inWorklist(numSyms, false);
+  for (Symbol* nonTer : this->nonTerminals) {
+    for (Symbol* tail : tails[nonTer->id]) {
+      if (followAffected[tail->id] && !inWorklist[nonTer->id]) {
+        inWorklist[nonTer->id] = true;
+        worklist.push_back(nonTer);
+      }
+    }
+  }
+  while (!worklist.empty()) {
+    Symbol* nonTer = worklist.front();
+    worklist.pop_front();
+    inWorklist[nonTer->id] = false;
+    for (Symbol* tail : tails[nonTer->id]) {
+      if (!followAffected[tail->id]) continue;
+      if (this->followSets[tail->id].unionWith(this->followSets[nonTer->id]) &&
+          !inWorklist[tail->id]) {
+        inWorklist[tail->id] = true;
+        worklist.push_back(tail);
+      }
+    }
+  }
+  vector<bool> followChanged(numSyms, false);
+  for (Symbol* nonTer : followWork) {
+    SymbolSet oldSet;
+    followChanged[nonTer->id] =
+        !toSymbolSet(old.followSets, nonTer, oldSet) ||
+        !(oldSet == this->followSets[nonTer->id]);
+  }
+
+  // 4. the table: a row only changes with the rules of its non-terminal, the
+  // first sets of their symbols and its follow set; other rows are restored
+  this->parsingTable.assign(numSyms, {});
+  int numRebuilt = 0;
+  for (Symbol* nonTer : this->nonTerminals) {
+    auto& row = this->parsingTable[nonTer->id];
+    bool rebuild = rulesChanged[nonTer->id] || followChanged[nonTer->id];
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      for (Symbol* rhsSym : pr->rhs) rebuild |= firstChanged[rhsSym->id];
+    }
+    auto it = old.rows.find(nonTer->name());
+    if (!rebuild && it != old.rows.end()) {
+      vector<Symbol*> rhs;
+      for (const auto& cell : it->second) {
+        Symbol* ipSym = this->symbolTable.find(cell.first);
+        rhs.clear();
+        for (string_view name : cell.second) {
+          rhs.push_back(this->symbolTable.find(name));
+        }
+        ProductionRule* pr = this->productionRules.find(nonTer, rhs);
+        if (ipSym == nullptr || pr == nullptr) {
+          rebuild = true;
+          break;
+        }
+        row.push_back({ipSym, pr});
+      }
+    }
+    if (rebuild) {
+      row.clear();
+      this->buildParsingTableRow(nonTer, row);
+      ++numRebuilt;
+    }
+  }
+
+  if (this->verbose) {
+    *this->log << "Incremental compilation: " << changedNonTers.size()
+         << " changed non-terminals, " << firstWork.size()
+         << " first sets and " << followWork.size()
+         << " follow sets recomputed, " << numRebuilt << " of "
+         << this->nonTerminals.size() << " table rows rebuilt\n";
+  }
+  return true;
+}
+
+void LL1::computeFollowOfRule(const ProductionRule* pr,
+                              vector<SymbolSet>& follow,
+                              vector<vector<Symbol*>>& dependents) const {
+  int epsId = this->epsSymbol->id;
+  // non-terminals on the rhs which are followed by the rest of the rhs
+  // seen so far, i.e. only by symbols deriving eps
+  vector<Symbol*> activeSyms;
+  for (Symbol* rhsSym : pr->rhs) {
+    if (rhsSym == this->epsSymbol) continue;
+    const SymbolSet& firstSetOfRhsSym = this->firstSets[rhsSym->id];
+    for (Symbol* activeSym : activeSyms) {
+      follow[activeSym->id].unionWith(firstSetOfRhsSym, epsId);
+    }
+    if (!firstSetOfRhsSym.contains(epsId)) activeSyms.clear();
+    if (!rhsSym->isTerminal) activeSyms.push_back(rhsSym);
+  }
+  // -> Follow sets of all the active-syms (at the end) contain
+  // Follow(lhsSym)
+  //    (This rule can introduce cycles and complicate things)
+  // -> For now let't just store it as a fact that "the follow of
+  // active-syms depend on lhsSym"
+  // (i.e., dependents[lhsSym] = active-syms)
+  for (Symbol* activeSym : activeSyms) {
+    dependents[pr->lhs->id].push_back(activeSym);
   }
 }
 
 void LL1::computeFollow() {
-  unordered_map<Symbol*, unordered_set<Symbol*>> dependents;
+  vector<vector<Symbol*>> dependents(this->totNumSyms);
 
-  this->followSetsMap[this->startSymbol].insert(this->dollarSymbol);
+  this->followSets.assign(this->totNumSyms, SymbolSet());
+  this->followSets[this->startSymbol->id].insert(this->dollarSymbol->id);
 
-  // parse all the production-rules once
-  for (const auto& symRules : this->productionRules) {
-    for (const ProductionRule* pr : symRules.second) {
-      unordered_set<Symbol*> activeSyms;
-      bool isEps = false;
-      for (Symbol* rhsSym : pr->rhs) {
-        if (rhsSym->isTerminal) {
-          isEps = (rhsSym == this->epsSymbol);
-          if (!isEps) {
-            for (Symbol* activeSym : activeSyms)
-              this->followSetsMap[activeSym].insert(rhsSym);
-          }
-        } else {
-          auto firstSetOfRhsSym = this->firstSetsMap[rhsSym];
-          isEps = false;
-          for (Symbol* firstOfRhs : firstSetOfRhsSym) {
-            isEps = isEps || (firstOfRhs == this->epsSymbol);
-            if (!(firstOfRhs == this->epsSymbol)) {
-              for (Symbol* activeSym : activeSyms)
-                this->followSetsMap[activeSym].insert(firstOfRhs);
-            }
-          }
-        }
-        if (!isEps) activeSyms.clear();
-        if (!rhsSym->isTerminal) activeSyms.insert(rhsSym);
-      }
-      // -> Follow sets of all the active-syms (at the end) contain
-      // Follow(lhsSym)
-      //    (This rule can introduce cycles and complicate things)
-      // -> For now let't just store it as a fact that "the follow of
-      // active-syms depend on lhsSym"
-      // (i.e., dependents[lhsSym] = active-syms)
-      if (activeSyms.size() > 0) {
-        for (Symbol* activeSym : activeSyms) {
-          dependents[pr->lhs].insert(activeSym);
+  if (this->threadPool == nullptr) {
+    // parse all the production-rules once
+    for (const ProductionRule* pr : this->productionRules.allRules()) {
+      this->computeFollowOfRule(pr, this->followSets, dependents);
+    }
+  } else {
+    this->computeFollowParallel(dependents);
+  }
+  this->propagateFollow(dependents);
+}
+
+void LL1::propagateFollow(const vector<vector<Symbol*>>& dependents) {
+  // Follow(A) contains Follow(X) for every X with A in dependents(X). In a
+  // component of that graph all the members end up with the same follow set:
+  // the union of their own entries and the follow sets of the components they
+  // depend on, which are complete at that point. So no fixed point is needed.
+  vector<vector<Symbol*>> dependsOn(this->totNumSyms);
+  for (Symbol* nonTer : this->nonTerminals) {
+    for (Symbol* depSym : dependents[nonTer->id]) {
+      dependsOn[depSym->id].push_back(nonTer);
+    }
+  }
+  for (const auto& level : sccLevels(this->nonTerminals, dependsOn)) {
+    ++this->numIterations;
+    auto propagate = [&](int i) {
+      const vector<Symbol*>& component = level[i];
+      SymbolSet followSet;
+      for (Symbol* member : component) {
+        followSet.unionWith(this->followSets[member->id]);
+        for (Symbol* lhs : dependsOn[member->id]) {
+          followSet.unionWith(this->followSets[lhs->id]);
         }
       }
+      for (Symbol* member : component) {
+        this->followSets[member->id] = followSet;
+      }
+    };
+    if (this->threadPool == nullptr) {
+      for (int i = 0; i < (int)level.size(); ++i) propagate(i);
+    } else {
+      this->threadPool->parallelFor(level.size(), propagate);
     }
   }
+}
 
-  // Now we must handle the dependencies
-  // First apply all the dependencies
-  // i.e. if dependents(X) contains A1, A2, ... Ak,
-  // make Follow(Ai) = Follow(Ai) UNION Follow(X) for all i = 1, 2, ..., k
-  // Keep repeating this step till there is no change in any of the follow-sets
-  bool didFollowSetUpdate = true;
-  while (didFollowSetUpdate) {
-    didFollowSetUpdate = false;
-    for (auto& dependent : dependents) {
-      for (Symbol* depSym : dependent.second) {
-        for (Symbol* followSymLhs : this->followSetsMap[dependent.first])
-          if (this->followSetsMap[depSym].insert(followSymLhs).second)
-            didFollowSetUpdate = true;
+void LL1::computeFollowParallel(vector<vector<Symbol*>>& dependents) {
+  // every worker parses the production rules of a slice of the non-terminals
+  // into its own sets; unions don't depend on order, so merging them gives
+  // the same sets as the serial pass
+  int numNonTers = this->nonTerminals.size();
+  int numSlices = this->threadPool->size();
+  vector<vector<SymbolSet>> localFollow(numSlices);
+  vector<vector<vector<Symbol*>>> localDependents(numSlices);
+  this->threadPool->parallelFor(numSlices, [&](int slice) {
+    localFollow[slice].resize(this->totNumSyms);
+    localDependents[slice].resize(this->totNumSyms);
+    int begin = (long long)numNonTers * slice / numSlices;
+    int end = (long long)numNonTers * (slice + 1) / numSlices;
+    for (int i = begin; i < end; ++i) {
+      for (const ProductionRule* pr :
+           this->productionRules.rulesOf(this->nonTerminals[i])) {
+        this->computeFollowOfRule(pr, localFollow[slice],
+                                  localDependents[slice]);
       }
     }
+  });
+  for (int slice = 0; slice < numSlices; ++slice) {
+    for (Symbol* nonTer : this->nonTerminals) {
+      this->followSets[nonTer->id].unionWith(localFollow[slice][nonTer->id]);
+      auto& sliceDependents = localDependents[slice][nonTer->id];
+      dependents[nonTer->id].insert(dependents[nonTer->id].end(),
+                                    sliceDependents.begin(),
+                                    sliceDependents.end());
+    }
   }
+}
 
-  // print follow sets
-  cout << "Follow-sets\n";
+void LL1::eliminateLeftRecursion() {
+  // leftCorners[A->id] = the non-terminal leading each rule of A (if any);
+  // left recursion is a cycle of this graph
+  vector<vector<Symbol*>> leftCorners(this->totNumSyms);
   for (Symbol* nonTer : this->nonTerminals) {
-    cout << nonTer->symbol << ": [ ";
-    for (Symbol* sym : this->followSetsMap[nonTer]) {
-      cout << sym->symbol << " ";
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      if (!pr->rhs.empty() && !pr->rhs[0]->isTerminal) {
+        leftCorners[nonTer->id].push_back(pr->rhs[0]);
+      }
+    }
+  }
+
+  // Substituting leading non-terminals only helps inside a strongly connected
+  // component of the graph: everything else is left as it is. Components are
+  // handled in order of their first member in nonTerminals, so the new A_'
+  // symbols are added in the same order as before.
+  vector<int> position(this->totNumSyms, -1);
+  for (int i = 0; i < (int)this->nonTerminals.size(); ++i) {
+    position[this->nonTerminals[i]->id] = i;
+  }
+  vector<vector<Symbol*>> components;
+  for (auto& level : sccLevels(this->nonTerminals, leftCorners)) {
+    for (auto& component : level) {
+      const vector<Symbol*>& corners = leftCorners[component[0]->id];
+      bool isCyclic = component.size() > 1 ||
+                      find(corners.begin(), corners.end(), component[0]) !=
+                          corners.end();
+      if (isCyclic) components.push_back(move(component));
+    }
+  }
+  auto firstPosition = [&position](const vector<Symbol*>& component) {
+    int first = position[component[0]->id];
+    for (Symbol* member : component) first = min(first, position[member->id]);
+    return first;
+  };
+  sort(components.begin(), components.end(),
+       [&](const vector<Symbol*>& a, const vector<Symbol*>& b) {
+         return firstPosition(a) < firstPosition(b);
+       });
+
+  // A member only used as the leading symbol of other members' rules never
+  // has to be derived on its own once the left recursion is gone
+  vector<int> componentOf(this->totNumSyms, -1);
+  for (int c = 0; c < (int)components.size(); ++c) {
+    for (Symbol* member : components[c]) componentOf[member->id] = c;
+  }
+  vector<bool> isUsedElsewhere(this->totNumSyms, false);
+  isUsedElsewhere[this->startSymbol->id] = true;
+  for (Symbol* nonTer : this->nonTerminals) {
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      for (int k = 0; k < (int)pr->rhs.size(); ++k) {
+        Symbol* sym = pr->rhs[k];
+        if (k > 0 || componentOf[sym->id] != componentOf[nonTer->id]) {
+          isUsedElsewhere[sym->id] = true;
+        }
+      }
+    }
+  }
+
+  // rank of the members of the component being rewritten (-1 elsewhere),
+  // shared by all components: allocating it per component is quadratic
+  vector<int> rank(this->totNumSyms, -1);
+  for (const vector<Symbol*>& component : components) {
+    long long paullRules = 0;
+    vector<Symbol*> order =
+        this->substitutionOrder(component, leftCorners, position, paullRules);
+    // The left-corner transform gives every member A used elsewhere one rule
+    // per rule of the component (plus A_'A -> ε), whatever the shape of the
+    // cycles. Paull's algorithm is usually smaller but can grow exponentially
+    // with the number of paths through the component, so it's only used when
+    // its estimate is no larger.
+    vector<Symbol*> kept;
+    long long numRules = 0;
+    for (Symbol* member : component) {
+      if (isUsedElsewhere[member->id]) kept.push_back(member);
+      numRules += this->productionRules.rulesOf(member).size();
+    }
+    if (kept.empty()) kept.push_back(component[0]);
+    long long cornerRules = (long long)kept.size() * (numRules + 1);
+    if (component.size() > 1 && paullRules > cornerRules) {
+      this->leftCornerTransform(component, kept);
+    } else {
+      this->eliminateLeftRecursionIn(order, rank);
     }
-    cout << "]\n";
   }
 }
 
-void LL1::eliminateLeftRecursion() {
-  for (int i = 0; i < this->nonTerminals.size(); ++i) {
-    auto& iProdRulesSet = this->productionRules[this->nonTerminals[i]];
+void LL1::leftCornerTransform(const vector<Symbol*>& component,
+                              const vector<Symbol*>& kept) {
+  // For members A (of kept), B and X of the component, A_'B derives what
+  // follows a B at the start of an A, once that B has been seen:
+  //   A -> b A_'B      for each rule B -> b not led by a member
+  //   A_'X -> c A_'B   for each rule B -> X c
+  //   A_'A -> ε
+  // so rules of members never start with a member any more. The other
+  // members are dropped.
+  auto& rules = this->productionRules;
+  int size = component.size(), numKept = kept.size();
+  unordered_map<Symbol*, int> index;
+  for (int i = 0; i < size; ++i) index[component[i]] = i;
+  vector<vector<vector<Symbol*>>> oldRules(size);
+  for (int i = 0; i < size; ++i) {
+    for (ProductionRule* pr : rules.rulesOf(component[i])) {
+      vector<Symbol*> rhs(pr->rhs);
+      // B -> ε contributes A -> A_'B
+      if (rhs.size() == 1 && rhs[0] == this->epsSymbol) rhs.clear();
+      oldRules[i].push_back(move(rhs));
+    }
+    // the replaced rules are deleted by the rule table
+    rules.removeAll(component[i]);
+  }
+  unordered_set<Symbol*> dropped(component.begin(), component.end());
+  for (Symbol* nonTer : kept) dropped.erase(nonTer);
+  vector<Symbol*> nonTers;
+  for (Symbol* nonTer : this->nonTerminals) {
+    if (!dropped.count(nonTer)) nonTers.push_back(nonTer);
+  }
+  this->nonTerminals = move(nonTers);
+
+  // seen[a][x] = A_'X for A = kept[a], X = component[x]
+  vector<vector<Symbol*>> seen(numKept, vector<Symbol*>(size));
+  for (int a = 0; a < numKept; ++a) {
+    for (int x = 0; x < size; ++x) {
+      string baseName =
+          string(kept[a]->name()) + "_'" + string(component[x]->name());
+      string name = baseName;
+      for (int n = 2; this->symbolTable.find(name) != nullptr; ++n) {
+        name = baseName + to_string(n);
+      }
+      seen[a][x] = this->addSymbol(name, false);
+      this->nonTerminals.push_back(seen[a][x]);
+    }
+  }
 
-    for (int j = 0; j < i; ++j) {
+  for (int a = 0; a < numKept; ++a) {
+    for (int b = 0; b < size; ++b) {
+      for (const vector<Symbol*>& rhs : oldRules[b]) {
+        auto leadIt = rhs.empty() ? index.end() : index.find(rhs[0]);
+        if (leadIt == index.end()) {
+          vector<Symbol*> newRhs(rhs);
+          newRhs.push_back(seen[a][b]);
+          rules.add(kept[a], move(newRhs));
+        } else {
+          vector<Symbol*> newRhs(rhs.begin() + 1, rhs.end());
+          newRhs.push_back(seen[a][b]);
+          rules.add(seen[a][leadIt->second], move(newRhs));
+        }
+      }
+    }
+    vector<Symbol*> epsRhs{this->epsSymbol};
+    rules.add(seen[a][index[kept[a]]], epsRhs);
+  }
+}
+
+vector<Symbol*> LL1::substitutionOrder(
+    const vector<Symbol*>& component,
+    const vector<vector<Symbol*>>& leftCorners,
+    const vector<int>& position, long long& numRules) const {
+  // Paull's algorithm replaces a leading Aj by all the rules of Aj whenever
+  // Aj comes earlier in the order, after Aj itself has been rewritten. The
+  // order is picked greedily: estimate[A] is the number of rules A ends up
+  // with if it comes next (a rule led by an earlier member counts as many
+  // rules as that member has), and the member with the smallest estimate
+  // goes next. Ties keep the order of nonTerminals.
+  unordered_map<Symbol*, long long> estimate;
+  // users[B] = (member, number of its rules led by B)
+  unordered_map<Symbol*, vector<pair<Symbol*, int>>> users;
+  for (Symbol* member : component) estimate[member] = 0;
+  for (Symbol* member : component) {
+    estimate[member] = this->productionRules.rulesOf(member).size();
+    unordered_map<Symbol*, int> ledBy;
+    for (Symbol* corner : leftCorners[member->id]) {
+      if (corner != member && estimate.count(corner)) ++ledBy[corner];
+    }
+    for (const auto& entry : ledBy) {
+      users[entry.first].push_back({member, entry.second});
+    }
+  }
+
+  // (estimate, position) of members not placed yet; stale entries are skipped
+  priority_queue<pair<long long, int>, vector<pair<long long, int>>,
+                 greater<pair<long long, int>>>
+      next;
+  unordered_map<int, Symbol*> atPosition;
+  for (Symbol* member : component) {
+    next.push({estimate[member], position[member->id]});
+    atPosition[position[member->id]] = member;
+  }
+  // estimates are capped so that huge blow-ups can't overflow
+  const long long maxEstimate = 1LL << 40;
+  vector<Symbol*> order;
+  unordered_set<Symbol*> placed;
+  numRules = 0;
+  while (!next.empty()) {
+    auto [memberEstimate, memberPosition] = next.top();
+    next.pop();
+    Symbol* member = atPosition[memberPosition];
+    if (placed.count(member) || memberEstimate != estimate[member]) continue;
+    placed.insert(member);
+    order.push_back(member);
+    numRules = min(maxEstimate, numRules + memberEstimate);
+    for (const auto& [user, numLed] : users[member]) {
+      if (placed.count(user)) continue;
+      estimate[user] =
+          min(maxEstimate, estimate[user] + (memberEstimate - 1) * numLed);
+      next.push({estimate[user], position[user->id]});
+    }
+  }
+  return order;
+}
+
+static int rankOf(const vector<int>& rank, const Symbol* sym) {
+  return sym->id < (int)rank.size() ? rank[sym->id] : -1;
+}
+
+void LL1::eliminateLeftRecursionIn(const vector<Symbol*>& order,
+                                   vector<int>& rank) {
+  auto& rules = this->productionRules;
+  // rank of every member of order, by id; the symbols added along the way
+  // (A_', A_base) are past the end of rank and never members
+  for (int i = 0; i < (int)order.size(); ++i) rank[order[i]->id] = i;
+
+  for (int i = 0; i < (int)order.size(); ++i) {
+    Symbol* iNonTer = order[i];
+
+    // Leading Aj (j < i) are replaced for increasing j as in the textbook
+    // loop, but it jumps straight to the next j leading a rule of Ai instead
+    // of trying every j < i (quadratic in the number of non-terminals)
+    for (int lastJ = -1;;) {
+      int j = i;
+      for (ProductionRule* pr : rules.rulesOf(iNonTer)) {
+        if (pr->rhs.empty() || pr->rhs[0]->isTerminal) continue;
+        int pos = rankOf(rank, pr->rhs[0]);
+        if (pos > lastJ && pos < j) j = pos;
+      }
+      if (j == i) break;
+      lastJ = j;
+      Symbol* jNonTer = order[j];
       // if prod-rule of Ai contains Aj in the beginning of the rule
       // replace Aj by all the productions of Aj
       vector<ProductionRule*> prsToBeRemoved;
-
-      for (ProductionRule* pr : iProdRulesSet) {
-        if (pr->rhs.size() > 0 && pr->rhs[0]->id == this->nonTerminals[j]->id) {
+      for (ProductionRule* pr : rules.rulesOf(iNonTer)) {
+        if (pr->rhs.size() > 0 && pr->rhs[0] == jNonTer) {
           prsToBeRemoved.push_back(pr);
         }
       }
+      if (prsToBeRemoved.empty()) continue;
 
+      RuleRange jRange = rules.rulesOf(jNonTer);
+      vector<ProductionRule*> jPRs(jRange.begin(), jRange.end());
       for (ProductionRule* pr : prsToBeRemoved) {
-        for (ProductionRule* jPR :
-             this->productionRules[this->nonTerminals[j]]) {
+        for (ProductionRule* jPR : jPRs) {
           vector<Symbol*> newRhs(jPR->rhs);
-          for (int k = 1; k < pr->rhs.size(); ++k) {
-            newRhs.push_back(pr->rhs[k]);
-          }
-          iProdRulesSet.insert(
-              new ProductionRule(this->nonTerminals[i], newRhs));
+          newRhs.insert(newRhs.end(), pr->rhs.begin() + 1, pr->rhs.end());
+          rules.add(iNonTer, move(newRhs));
         }
-        delete pr;
-        iProdRulesSet.erase(pr);
+        // the replaced rule is deleted by the rule table
+        rules.remove(pr);
       }
     }
 
-    // remove left recursion from Ai's production-rules
-    vector<ProductionRule*> leftRecursiveRules, nonLeftRecRules;
-    for (ProductionRule* pr : iProdRulesSet) {
-      if (pr->rhs.size() > 0 && pr->rhs[0]->id == this->nonTerminals[i]->id) {
-        leftRecursiveRules.push_back(pr);
-      } else {
-        nonLeftRecRules.push_back(pr);
-      }
+    this->removeDirectLeftRecursion(iNonTer);
+    this->splitBaseRules(iNonTer, rank);
+  }
+  for (Symbol* member : order) rank[member->id] = -1;
+}
+
+void LL1::splitBaseRules(Symbol* nonTer, const vector<int>& rank) {
+  // Later members get every rule of nonTer copied into their rules led by
+  // it, but only the rules led by a member can lead back into the cycle.
+  // The others (the base rules) are moved to a new non-terminal, so that
+  // each substitution copies a single rule for all of them.
+  auto& rules = this->productionRules;
+  vector<ProductionRule*> baseRules;
+  bool hasMemberLed = false;
+  for (ProductionRule* pr : rules.rulesOf(nonTer)) {
+    bool isMemberLed = !pr->rhs.empty() && !pr->rhs[0]->isTerminal &&
+                       rankOf(rank, pr->rhs[0]) >= 0;
+    if (isMemberLed) {
+      hasMemberLed = true;
+    } else {
+      baseRules.push_back(pr);
+    }
+  }
+  if (!hasMemberLed || baseRules.size() < 2) return;
+
+  Symbol* baseSym = this->addSymbol(string(nonTer->name()) + "_base", false);
+  this->nonTerminals.push_back(baseSym);
+  for (ProductionRule* pr : baseRules) {
+    vector<Symbol*> rhs(pr->rhs);
+    rules.remove(pr);
+    rules.add(baseSym, move(rhs));
+  }
+  vector<Symbol*> baseRhs{baseSym};
+  rules.add(nonTer, baseRhs);
+}
+
+void LL1::removeDirectLeftRecursion(Symbol* iNonTer) {
+  auto& rules = this->productionRules;
+  // remove left recursion from Ai's production-rules
+  vector<ProductionRule*> leftRecursiveRules, nonLeftRecRules;
+  for (ProductionRule* pr : rules.rulesOf(iNonTer)) {
+    if (pr->rhs.size() > 0 && pr->rhs[0] == iNonTer) {
+      leftRecursiveRules.push_back(pr);
+    } else {
+      nonLeftRecRules.push_back(pr);
     }
+  }
+  if (leftRecursiveRules.empty()) return;
+
+  // add new non-terminal A'
+  Symbol* newSym = this->addSymbol(string(iNonTer->name()) + "_'", false);
+  this->nonTerminals.push_back(newSym);
+
+  for (ProductionRule* rule : leftRecursiveRules) {
+    if (rule->rhs.size() == 1) continue;
+    // erase Ai from the beginning and append A' to the end of each rule
+    vector<Symbol*> newRhs(rule->rhs.begin() + 1, rule->rhs.end());
+    newRhs.push_back(newSym);
+    rules.add(newSym, move(newRhs));
+  }
 
-    if (leftRecursiveRules.size() > 0) {
-      // add new non-terminal A'
-      int newSymId = this->totNumSyms++;
-      Symbol* newSym =
-          new Symbol(newSymId, this->nonTerminals[i]->symbol + "_'", false);
-      this->nonTerminals.push_back(newSym);
+  vector<Symbol*> epsRhs{this->epsSymbol};
+  rules.add(newSym, epsRhs);
 
-      for (ProductionRule* rule : leftRecursiveRules) {
-        if (rule->rhs.size() == 1) continue;
-        // erase Ai from the beginning and append A' to the end of each rule
-        vector<Symbol*> newRhs;
-        for (int k = 1; k < rule->rhs.size(); ++k) {
-          newRhs.push_back(rule->rhs[k]);
-        }
-        newRhs.push_back(newSym);
-        this->productionRules[newSym].insert(
-            new ProductionRule(newSym, newRhs));
-      }
+  // delete all the production-rules in leftRecursiveRules
+  for (ProductionRule* rule : leftRecursiveRules) {
+    rules.remove(rule);
+  }
+
+  // Ai -> beta   becomes   Ai -> beta A'
+  for (ProductionRule* rule : nonLeftRecRules) {
+    vector<Symbol*> newRhs(rule->rhs);
+    newRhs.push_back(newSym);
+    rules.remove(rule);
+    rules.add(iNonTer, move(newRhs));
+  }
+}
 
-      vector<Symbol*> epsRhs{this->epsSymbol};
-      this->productionRules[newSym].insert(new ProductionRule(newSym, epsRhs));
+// Node of the prefix trie of a non-terminal's production rules
+struct PrefixTrieNode {
+  // child nodes (indices into the trie), in order of first insertion
+  vector<pair<Symbol*, int>> children;
+  unordered_map<Symbol*, int> childIndex;
+  // true if some production rule ends at this node
+  bool isEnd = false;
+};
+
+const SymbolSet& LL1::leadingSymbols(Symbol* sym,
+                                     unordered_map<Symbol*, SymbolSet>& memo) {
+  auto memoIt = memo.find(sym);
+  if (memoIt != memo.end()) return memoIt->second;
+  // insert before recursing: a (left-recursive) cycle sees a partial set
+  SymbolSet& leading = memo[sym];
+  leading.insert(sym->id);
+  if (sym->isTerminal) return leading;
+  for (ProductionRule* pr : this->productionRules.rulesOf(sym)) {
+    if (pr->rhs.size() == 0) continue;
+    leading.unionWith(this->leadingSymbols(pr->rhs[0], memo));
+  }
+  return leading;
+}
 
-      for (ProductionRule* rule : nonLeftRecRules) {
-        rule->rhs.push_back(newSym);
+void LL1::expandLeadingNonTerminals(Symbol* nonTer) {
+  auto& rules = this->productionRules;
+  unordered_set<Symbol*> expanded;
+  bool didExpand = true;
+  while (didExpand) {
+    didExpand = false;
+    RuleRange range = rules.rulesOf(nonTer);
+    vector<ProductionRule*> prs(range.begin(), range.end());
+    // leading symbols must be recomputed after every expansion
+    unordered_map<Symbol*, SymbolSet> memo;
+    for (ProductionRule* pr : prs) {
+      if (pr->rhs.size() == 0 || pr->rhs[0]->isTerminal) continue;
+      Symbol* leadNonTer = pr->rhs[0];
+      if (leadNonTer == nonTer || expanded.count(leadNonTer)) continue;
+
+      // only expand if the expansion exposes a prefix shared with another rule
+      // (sharing a non-terminal means sharing the terminals it starts with)
+      const SymbolSet& leading = this->leadingSymbols(leadNonTer, memo);
+      bool sharesPrefix = false;
+      for (ProductionRule* other : prs) {
+        if (other == pr || other->rhs.size() == 0) continue;
+        if (leading.intersects(this->leadingSymbols(other->rhs[0], memo))) {
+          sharesPrefix = true;
+          break;
+        }
       }
-
-      // delete all the production-rules in leftRecursiveRules
-      for (ProductionRule* rule : leftRecursiveRules) {
-        delete rule;
-        iProdRulesSet.erase(rule);
+      if (!sharesPrefix) continue;
+
+      // nonTer -> B beta   becomes   nonTer -> b1 beta | b2 beta | ...,
+      // for every rule of nonTer led by B: B is never expanded again
+      RuleRange leadRange = rules.rulesOf(leadNonTer);
+      vector<ProductionRule*> leadPRs(leadRange.begin(), leadRange.end());
+      for (ProductionRule* ledPr : prs) {
+        if (ledPr->rhs.size() == 0 || ledPr->rhs[0] != leadNonTer) continue;
+        vector<Symbol*> beta(ledPr->rhs.begin() + 1, ledPr->rhs.end());
+        rules.remove(ledPr);
+        for (ProductionRule* leadPr : leadPRs) {
+          vector<Symbol*> newRhs;
+          for (Symbol* sym : leadPr->rhs) {
+            if (sym != this->epsSymbol) newRhs.push_back(sym);
+          }
+          newRhs.insert(newRhs.end(), beta.begin(), beta.end());
+          if (newRhs.size() == 0) newRhs.push_back(this->epsSymbol);
+          rules.add(nonTer, move(newRhs));
+        }
       }
+      // every non-terminal is expanded at most once, so this terminates even
+      // if the expansions are recursive
+      expanded.insert(leadNonTer);
+      didExpand = true;
+      break;
     }
   }
 }
 
 void LL1::leftFactor() {
-  for (int i = 0; i < this->nonTerminals.size(); ++i) {
+  // non-terminals added below are built from already factored suffixes
+  int numNonTers = this->nonTerminals.size();
+  for (int i = 0; i < numNonTers; ++i) {
     Symbol* nonTer = this->nonTerminals[i];
+    if (this->expandLeadingNonTers) {
+      this->expandLeadingNonTerminals(nonTer);
+    }
+    RuleRange prs = this->productionRules.rulesOf(nonTer);
+
+    // build a prefix trie of the rhs of all the production rules of nonTer
+    // (epsilon is the empty string, i.e. it ends at the root)
+    vector<PrefixTrieNode> trie(1);
+    for (ProductionRule* pr : prs) {
+      int node = 0;
+      for (Symbol* sym : pr->rhs) {
+        if (sym == this->epsSymbol) continue;
+        auto childIt = trie[node].childIndex.find(sym);
+        if (childIt != trie[node].childIndex.end()) {
+          node = childIt->second;
+          continue;
+        }
+        int child = trie.size();
+        trie[node].children.push_back({sym, child});
+        trie[node].childIndex[sym] = child;
+        trie.emplace_back();
+        node = child;
+      }
+      trie[node].isEnd = true;
+    }
 
-    // propagate prefix map by first symbol on the rhs of each of the production
-    // rule of the current nonTer
-    unordered_map<Symbol*, unordered_set<ProductionRule*>> prefixMap;
-    for (ProductionRule* rule : this->productionRules[nonTer]) {
-      if (rule->rhs.size() > 0) {
-        prefixMap[rule->rhs[0]].insert(rule);
+    // nothing to do unless two rules share a prefix (a node below the root
+    // branches)
+    bool needsFactoring = false;
+    for (int node = 1; node < (int)trie.size() && !needsFactoring; ++node) {
+      needsFactoring = (trie[node].children.size() + trie[node].isEnd > 1);
+    }
+    if (!needsFactoring) continue;
+
+    this->productionRules.removeAll(nonTer);
+
+    // Every branching node below the root becomes a new non-terminal that
+    // derives the suffixes of its subtree; chains of non-branching nodes are
+    // collapsed into the rhs leading to it. The trie is walked with an
+    // explicit stack of (lhs, node whose subtrees lhs derives).
+    vector<pair<Symbol*, int>> pending{{nonTer, 0}};
+    while (!pending.empty()) {
+      Symbol* lhs = pending.back().first;
+      int branchNode = pending.back().second;
+      pending.pop_back();
+
+      if (trie[branchNode].isEnd) {
+        vector<Symbol*> epsRhs{this->epsSymbol};
+        this->productionRules.add(lhs, epsRhs);
+      }
+      for (const auto& child : trie[branchNode].children) {
+        vector<Symbol*> newRhs{child.first};
+        int node = child.second;
+        while (trie[node].children.size() == 1 && !trie[node].isEnd) {
+          newRhs.push_back(trie[node].children[0].first);
+          node = trie[node].children[0].second;
+        }
+        if (trie[node].children.size() > 0) {
+          // insert new symbol, which will derive all the suffixes of the
+          // rules having the common prefix "newRhs"
+          Symbol* newSym =
+              this->addSymbol("NT_" + to_string(this->totNumSyms), false);
+          this->nonTerminals.push_back(newSym);
+          newRhs.push_back(newSym);
+          pending.push_back({newSym, node});
+        }
+        this->productionRules.add(lhs, move(newRhs));
       }
     }
+  }
+}
 
-    for (auto mapEntry : prefixMap) {
-      // if two or more production rules are starting with the same symbol, we
-      // need to factor those rules
-      if (mapEntry.second.size() > 1) {
-        auto& prs = mapEntry.second;
+void LL1::minimizeGrammar() {
+  int numNonTers = this->nonTerminals.size();
+  int numRules = this->productionRules.size();
+  int numEntries;
+  double expansionsPerSym;
+  this->productionRules.compact(this->nonTerminals);
+  this->computeFirst();
+  this->computeFollow();
+  this->measureTable(numEntries, expansionsPerSym);
 
-        // try to find the longest prefix common to all the production rules in
-        // the current set (having same first symbol, hence, length of longest
-        // prefix >= 1)
-        vector<Symbol*> commonSyms((*(mapEntry.second.begin()))->rhs);
-        for (ProductionRule* pr : prs) {
-          while (pr->rhs.size() < commonSyms.size()) {
-            commonSyms.pop_back();
-          }
-          // Check from commonSyms.size()-1 to 0
-          int lastMismatch = commonSyms.size();
-          for (int ind = commonSyms.size() - 1; ind >= 0; --ind) {
-            if (pr->rhs[ind] != commonSyms[ind]) {
-              lastMismatch = ind;
-            }
-          }
-          while (commonSyms.size() > lastMismatch) {
-            commonSyms.pop_back();
-          }
-          // while (commonSyms.size() > 0 && (pr->rhs[commonSyms.size() - 1] !=
-          //                                  commonSyms[commonSyms.size() -
-          //                                  1])) {
-          //   commonSyms.pop_back();
-          // }
+  this->removeUselessNonTerminals();
+  // inlining leaves single-use non-terminals unreachable
+  while (this->inlineProductions()) this->removeUselessNonTerminals();
+
+  int newNumEntries;
+  double newExpansionsPerSym;
+  this->productionRules.compact(this->nonTerminals);
+  this->computeFirst();
+  this->computeFollow();
+  this->measureTable(newNumEntries, newExpansionsPerSym);
+  char expansions[64];
+  snprintf(expansions, sizeof(expansions), "%.2f -> %.2f", expansionsPerSym,
+           newExpansionsPerSym);
+  *this->log << "Minimized grammar: non-terminals " << numNonTers << " -> "
+       << this->nonTerminals.size() << ", rules " << numRules << " -> "
+       << this->productionRules.size() << ", table entries " << numEntries
+       << " -> " << newNumEntries << ", expansions per input symbol "
+       << expansions << "\n";
+}
+
+void LL1::removeUselessNonTerminals() {
+  // productive: derives some terminal string, i.e. has a rule with only
+  // terminals and productive non-terminals on its rhs
+  vector<bool> isProductive(this->totNumSyms, false);
+  bool didGrow = true;
+  while (didGrow) {
+    didGrow = false;
+    for (Symbol* nonTer : this->nonTerminals) {
+      if (isProductive[nonTer->id]) continue;
+      for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+        bool allProductive = true;
+        for (Symbol* rhsSym : pr->rhs) {
+          allProductive &= rhsSym->isTerminal || isProductive[rhsSym->id];
+        }
+        if (allProductive) {
+          isProductive[nonTer->id] = didGrow = true;
+          break;
         }
+      }
+    }
+  }
+  for (Symbol* nonTer : this->nonTerminals) {
+    vector<ProductionRule*> useless;
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      for (Symbol* rhsSym : pr->rhs) {
+        if (!rhsSym->isTerminal && !isProductive[rhsSym->id]) {
+          useless.push_back(pr);
+          break;
+        }
+      }
+    }
+    for (ProductionRule* pr : useless) this->productionRules.remove(pr);
+  }
 
-        // insert new symbol, which will derive all the rules with common prefix
-        // "commonSyms"
-        int newSymId = this->totNumSyms++;
-        Symbol* newSym =
-            new Symbol(newSymId, "NT_" + to_string(newSymId), false);
-        this->nonTerminals.push_back(newSym);
+  // reachable from the start symbol through the remaining rules (the start
+  // symbol itself always stays)
+  vector<bool> isReachable(this->totNumSyms, false);
+  vector<Symbol*> pending{this->startSymbol};
+  isReachable[this->startSymbol->id] = true;
+  while (!pending.empty()) {
+    Symbol* nonTer = pending.back();
+    pending.pop_back();
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      for (Symbol* rhsSym : pr->rhs) {
+        if (!rhsSym->isTerminal && !isReachable[rhsSym->id]) {
+          isReachable[rhsSym->id] = true;
+          pending.push_back(rhsSym);
+        }
+      }
+    }
+  }
+  vector<Symbol*> usefulNonTers;
+  for (Symbol* nonTer : this->nonTerminals) {
+    if (isReachable[nonTer->id] &&
+        (isProductive[nonTer->id] || nonTer == this->startSymbol)) {
+      usefulNonTers.push_back(nonTer);
+    } else {
+      this->productionRules.removeAll(nonTer);
+    }
+  }
+  this->nonTerminals = move(usefulNonTers);
+}
 
-        // propagate rules of the new symbol
-        bool isEps = false;
-        for (ProductionRule* pr : prs) {
-          vector<Symbol*> newRhs;
-          if (pr->rhs.size() == commonSyms.size()) {
-            if (isEps) continue;
-            // if rhs == "commonSyms" for some production rule,
-            // the new symbol must derive epsilon (exactly once)
-            newRhs.push_back(this->epsSymbol);
-            isEps = true;
-          } else {
-            // new symbol has to derive {rhs-(common prefix "commonSyms")}
-            for (int k = commonSyms.size(); k < pr->rhs.size(); ++k) {
-              newRhs.push_back(pr->rhs[k]);
-            }
-          }
-          this->productionRules[newSym].insert(
-              new ProductionRule(newSym, newRhs));
+bool LL1::inlineProductions() {
+  // Replacing B in A -> x B y by the rhs of each rule of B keeps the predict
+  // sets of the new rules inside the old predict sets (so LL(1) grammars stay
+  // LL(1)) when the rule is a unit rule (A -> B), or when B is used only
+  // here and either has a single rule or comes first in the rhs. Other
+  // cases would give the new rules the common prefix x.
+  vector<int> uses(this->totNumSyms, 0);
+  for (Symbol* nonTer : this->nonTerminals) {
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      for (Symbol* rhsSym : pr->rhs) ++uses[rhsSym->id];
+    }
+  }
+  auto isRecursive = [this](Symbol* nonTer) {
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      if (find(pr->rhs.begin(), pr->rhs.end(), nonTer) != pr->rhs.end()) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  bool didInline = false;
+  for (Symbol* lhs : this->nonTerminals) {
+    vector<vector<Symbol*>> newRhss;
+    bool rowChanged = false;
+    for (ProductionRule* pr : this->productionRules.rulesOf(lhs)) {
+      int pos = -1;
+      for (int i = 0; i < (int)pr->rhs.size() && pos < 0; ++i) {
+        Symbol* sym = pr->rhs[i];
+        if (sym->isTerminal || sym == lhs || sym == this->startSymbol ||
+            isRecursive(sym)) {
+          continue;
         }
+        RuleRange symPrs = this->productionRules.rulesOf(sym);
+        bool isUnit = pr->rhs.size() == 1;
+        if (!isUnit && (uses[sym->id] > 1 || (i > 0 && symPrs.size() > 1))) {
+          continue;
+        }
+        // A -> B with B -> A would leave the cycle A -> A
+        bool makesCycle = false;
+        for (ProductionRule* symPr : symPrs) {
+          makesCycle |=
+              isUnit && symPr->rhs.size() == 1 && symPr->rhs[0] == lhs;
+        }
+        if (!makesCycle) pos = i;
+      }
+      if (pos < 0) {
+        newRhss.push_back(pr->rhs);
+        continue;
+      }
 
-        // add new rule to nonTer
-        // nonTer -> [ commonSyms newSymbol ]
-        vector<Symbol*> newRhs(commonSyms);
-        newRhs.push_back(newSym);
-        this->productionRules[nonTer].insert(
-            new ProductionRule(nonTer, newRhs));
-
-        // remove factored rules from nonTer
-        for (ProductionRule* pr : prs) {
-          delete pr;
-          this->productionRules[nonTer].erase(pr);
+      Symbol* inlined = pr->rhs[pos];
+      --uses[inlined->id];
+      for (ProductionRule* symPr : this->productionRules.rulesOf(inlined)) {
+        vector<Symbol*> rhs(pr->rhs.begin(), pr->rhs.begin() + pos);
+        for (Symbol* sym : symPr->rhs) {
+          if (sym != this->epsSymbol) rhs.push_back(sym);
         }
+        rhs.insert(rhs.end(), pr->rhs.begin() + pos + 1, pr->rhs.end());
+        if (rhs.empty()) rhs.push_back(this->epsSymbol);
+        for (Symbol* sym : symPr->rhs) ++uses[sym->id];
+        newRhss.push_back(rhs);
       }
+      rowChanged = true;
     }
+    if (!rowChanged) continue;
+    // re-add the row in order, with the inlined rules where the old one was
+    this->productionRules.removeAll(lhs);
+    for (const vector<Symbol*>& rhs : newRhss) {
+      this->productionRules.add(lhs, rhs);
+    }
+    didInline = true;
   }
+  return didInline;
 }
 
-void LL1::readCFG() {
-  this->symToPtr.clear();
-  unordered_map<string, int> symToId;
+void LL1::measureTable(int& numEntries, double& expansionsPerSym) const {
+  // rule[cell] for every cell (the first rule, if the grammar isn't LL(1))
+  unordered_map<long long, ProductionRule*> cellRule;
+  auto cellOf = [](const Symbol* nonTer, int ipSymId) {
+    return ((long long)nonTer->id << 32) | ipSymId;
+  };
+  for (Symbol* nonTer : this->nonTerminals) {
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      SymbolSet predict;
+      if (this->firstOfRule(pr, predict)) {
+        predict.unionWith(this->followSets[nonTer->id]);
+      }
+      predict.forEach([&](int ipSymId) {
+        cellRule.insert({cellOf(nonTer, ipSymId), pr});
+      });
+    }
+  }
+  numEntries = cellRule.size();
+
+  // expansions(A, t): rules applied from A on top of the stack till t is
+  // on top, i.e. 1 + expansions(B, t) if the rule starts with B deriving t
+  unordered_map<long long, int> expansions;
+  function<int(Symbol*, int)> expansionsOf = [&](Symbol* nonTer,
+                                                int ipSymId) {
+    long long cell = cellOf(nonTer, ipSymId);
+    auto known = expansions.find(cell);
+    if (known != expansions.end()) return known->second;
+    // a cycle (not LL(1)) ends here
+    expansions[cell] = 1;
+    int count = 1;
+    auto rule = cellRule.find(cell);
+    if (rule != cellRule.end()) {
+      Symbol* first = rule->second->rhs[0];
+      if (!first->isTerminal &&
+          this->firstSets[first->id].contains(ipSymId)) {
+        count += expansionsOf(first, ipSymId);
+      }
+    }
+    expansions[cell] = count;
+    return count;
+  };
+  long long total = 0;
+  for (const auto& entry : cellRule) {
+    total += expansionsOf(entry.second->lhs, entry.first & 0xffffffff);
+  }
+  expansionsPerSym = numEntries > 0 ? (double)total / numEntries : 0;
+}
+
+void LL1::readCFG(istream& in, bool interactive) {
   string sym;
+  // prompts go nowhere when the grammar comes from a file
+  ostream prompt(interactive ? cout.rdbuf() : nullptr);
 
-  cout << "Note: terminal symbols and non-terminal symbols can be strings. "
-          "The string must not contain either of whitespace, tab, newline, ']' "
-          "and '_'. Use \""
-       << EPSILON_SYMBOL << "\" as epsilon \n\n";
+  prompt << "Note: terminal symbols and non-terminal symbols can be strings. "
+            "The string must not contain either of whitespace, tab, newline, "
+            "']' and '_'. Use \""
+         << EPSILON_SYMBOL << "\" as epsilon \n\n";
 
   // add epsilon to grammar
-  this->symToPtr[EPSILON_SYMBOL] =
-      new Symbol(this->totNumSyms, EPSILON_SYMBOL, true);
-  symToId[EPSILON_SYMBOL] = this->totNumSyms;
-  this->epsSymbol = this->symToPtr[EPSILON_SYMBOL];
-  // this->terminals.push_back(this->symToPtr[EPSILON_SYMBOL]);
-  this->totNumSyms++;
+  this->epsSymbol = this->addSymbol(EPSILON_SYMBOL, true);
 
   //  add $ symbol to grammar
-  this->symToPtr[DOLLAR_SYMBOL] =
-      new Symbol(this->totNumSyms, DOLLAR_SYMBOL, true);
-  symToId[DOLLAR_SYMBOL] = this->totNumSyms;
-  this->dollarSymbol = this->symToPtr[DOLLAR_SYMBOL];
-  // this->terminals.push_back(this->symToPtr[DOLLAR_SYMBOL]);
-  this->totNumSyms++;
+  this->dollarSymbol = this->addSymbol(DOLLAR_SYMBOL, true);
 
   int numNonTers, numTers, numProdRules;
-  cout << "Enter number of non-terminals: ";
-  cin >> numNonTers;
-  cout << "Enter " << numNonTers << " non-terminals:\n";
+  prompt << "Enter number of non-terminals: ";
+  in >> numNonTers;
+  prompt << "Enter " << numNonTers << " non-terminals:\n";
   for (int i = 0; i < numNonTers; ++i) {
-    cin >> sym;
-    this->symToPtr[sym] = new Symbol(this->totNumSyms, sym, false);
-    symToId[sym] = this->totNumSyms;
-    this->nonTerminals.push_back(this->symToPtr[sym]);
-    ++this->totNumSyms;
+    in >> sym;
+    assert(this->symbolTable.find(sym) == nullptr);
+    this->nonTerminals.push_back(this->addSymbol(sym, false));
   }
 
-  cout << "Enter number of terminals: ";
-  cin >> numTers;
-  cout << "Enter " << numTers << " terminals:\n";
+  prompt << "Enter number of terminals: ";
+  in >> numTers;
+  prompt << "Enter " << numTers << " terminals:\n";
   for (int i = 0; i < numTers; ++i) {
-    cin >> sym;
-    this->symToPtr[sym] = new Symbol(this->totNumSyms, sym, true);
-    symToId[sym] = this->totNumSyms;
-    this->terminals.push_back(this->symToPtr[sym]);
-    ++this->totNumSyms;
-  }
-
-  cout << "\n===\n";
-  cout << "Production rule must have the "
-          "following format:\n";
-  cout << "Non-terminal -> [ a space separated list of terminals and "
-          "non-terminals (first and last symbols on rhs must be separated from "
-          "the square brackets by at least one space)\n";
-  cout << "Example: A -> [ a B C d a A ]\n";
-  cout << "===\n\n";
-
-  cout << "Enter number of production rules:\n";
-  cin >> numProdRules;
-  cout << "Enter " << numProdRules << " production rules:\n";
+    in >> sym;
+    assert(this->symbolTable.find(sym) == nullptr);
+    this->terminals.push_back(this->addSymbol(sym, true));
+  }
+  // every name the rules can refer to is known now
+  this->symbolTable.freeze();
+
+  prompt << "\n===\n";
+  prompt << "Production rule must have the "
+            "following format:\n";
+  prompt << "Non-terminal -> [ a space separated list of terminals and "
+            "non-terminals (first and last symbols on rhs must be separated "
+            "from the square brackets by at least one space)\n";
+  prompt << "Example: A -> [ a B C d a A ]\n";
+  prompt << "EBNF: " << EBNF_REPEAT_BEGIN << " ... " << EBNF_REPEAT_END
+         << " repeats (zero or more times), " << EBNF_OPTIONAL_BEGIN
+         << " ... " << EBNF_OPTIONAL_END << " is optional\n";
+  prompt << "Example: A -> [ a " << EBNF_REPEAT_BEGIN << " , a "
+         << EBNF_REPEAT_END << " ]\n";
+  prompt << "===\n\n";
+
+  prompt << "Enter number of production rules:\n";
+  in >> numProdRules;
+  prompt << "Enter " << numProdRules << " production rules:\n";
   for (int i = 0; i < numProdRules; ++i) {
     string tmpStr, lhsStr;
     // parsing the production rules
 
-    cin >> sym;
-    assert(this->symToPtr.find(sym) != this->symToPtr.end());
-    assert(!this->symToPtr[sym]->isTerminal);
-    Symbol* lhs = this->symToPtr[sym];
+    in >> sym;
+    Symbol* lhs = this->symbolTable.find(sym);
+    assert(lhs != nullptr);
+    assert(!lhs->isTerminal);
     lhsStr = sym;
 
-    cin >> tmpStr;
+    in >> tmpStr;
     assert(tmpStr == "->");
 
-    cin >> tmpStr;
+    in >> tmpStr;
     assert(tmpStr == "[");
-    cin >> sym;
-    vector<Symbol*> rhs;
+    in >> sym;
+    vector<RhsGroup> groups{{"[", {{}}}};
     while (sym != "]") {
-      if (sym == PRODUCTION_RULE_OR) {
-        this->productionRules[this->symToPtr[lhsStr]].insert(
-            new ProductionRule(lhs, rhs));
-        rhs.clear();
-      } else {
-        assert(this->symToPtr.find(sym) != this->symToPtr.end());
-        rhs.push_back(this->symToPtr[sym]);
+      string error = this->addRhsToken(lhs, groups, sym);
+      assert(error == "");
+      in >> sym;
+    }
+    assert(groups.size() == 1);
+
+    for (const vector<Symbol*>& rhs : groups[0].alternatives) {
+      this->productionRules.add(lhs, rhs);
+    }
+  }
+
+  prompt << "Enter start symbol: ";
+  in >> sym;
+  this->startSymbol = this->symbolTable.find(sym);
+  assert(this->startSymbol != nullptr);
+  assert(!this->startSymbol->isTerminal);
+}
+
+void LL1::readCFGFile(const string& path) {
+  GrammarReader reader(path);
+
+  this->epsSymbol = this->addSymbol(EPSILON_SYMBOL, true);
+  this->dollarSymbol = this->addSymbol(DOLLAR_SYMBOL, true);
+
+  // declarations: count followed by that many names, non-terminals first
+  for (int pass = 0; pass < 2; ++pass) {
+    bool isTerminal = (pass == 1);
+    const char* what =
+        isTerminal ? "number of terminals" : "number of non-terminals";
+    int numSyms = reader.nextCount(what);
+    for (int i = 0; i < numSyms; ++i) {
+      string_view name = reader.expectToken(isTerminal ? "a terminal"
+                                                       : "a non-terminal");
+      if (this->symbolTable.find(name) != nullptr) {
+        throw reader.errorAtToken("symbol \"" + string(name) +
+                                  "\" is declared twice");
       }
-      cin >> sym;
+      Symbol* sym = this->addSymbol(name, isTerminal);
+      (isTerminal ? this->terminals : this->nonTerminals).push_back(sym);
+    }
+  }
+  this->symbolTable.freeze();
+
+  int numProdRules = reader.nextCount("number of production rules");
+  for (int i = 0; i < numProdRules; ++i) {
+    string_view name = reader.expectToken("a production rule");
+    Symbol* lhs = this->symbolTable.find(name);
+    if (lhs == nullptr || lhs->isTerminal) {
+      throw reader.errorAtToken("\"" + string(name) +
+                                "\" is not a non-terminal");
+    }
+    reader.expect("->");
+    reader.expect("[");
+    vector<RhsGroup> groups{{"[", {{}}}};
+    for (name = reader.expectToken("\"]\""); name != "]";
+         name = reader.expectToken("\"]\"")) {
+      string error = this->addRhsToken(lhs, groups, name);
+      if (error != "") throw reader.errorAtToken(error);
+    }
+    if (groups.size() > 1) {
+      throw reader.errorAtToken("\"" + groups.back().opener +
+                                "\" is not closed");
     }
+    for (const vector<Symbol*>& rhs : groups[0].alternatives) {
+      this->productionRules.add(lhs, rhs);
+    }
+  }
 
-    this->productionRules[this->symToPtr[lhsStr]].insert(
-        new ProductionRule(lhs, rhs));
+  string_view name = reader.expectToken("the start symbol");
+  this->startSymbol = this->symbolTable.find(name);
+  if (this->startSymbol == nullptr || this->startSymbol->isTerminal) {
+    throw reader.errorAtToken("start symbol \"" + string(name) +
+                              "\" is not a non-terminal");
   }
+}
 
-  cout << "Enter start symbol: ";
-  cin >> sym;
-  assert(this->symToPtr.find(sym) != this->symToPtr.end());
-  assert(!this->symToPtr[sym]->isTerminal);
-  this->startSymbol = this->symToPtr[sym];
+// FNV-1a of str, starting from the given offset basis
+static uint64_t fnv1a(const string& str, uint64_t hash) {
+  for (unsigned char c : str) {
+    hash = (hash ^ c) * 0x100000001b3ULL;
+  }
+  return hash;
+}
+
+string LL1::hashGrammar() const {
+  // the grammar as read, independent of whitespace and of duplicate rules,
+  // plus everything else that changes the generated files
+  string normalized = GENERATOR_VERSION;
+  normalized += this->expandLeadingNonTers ? " x" : "";
+  normalized += (this->lookahead > 1) ? " k" + to_string(this->lookahead) : "";
+  normalized += this->adaptive ? " a" : "";
+  normalized += this->minimize ? " m" : "";
+  normalized += "\n";
+  for (const vector<Symbol*>* syms : {&this->nonTerminals, &this->terminals}) {
+    normalized += to_string(syms->size());
+    for (Symbol* sym : *syms) {
+      normalized += " ";
+      normalized += sym->name();
+    }
+    normalized += "\n";
+  }
+  for (Symbol* nonTer : this->nonTerminals) {
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      normalized += nonTer->name();
+      normalized += " ->";
+      for (Symbol* rhsSym : pr->rhs) {
+        normalized += " ";
+        normalized += rhsSym->name();
+      }
+      normalized += "\n";
+    }
+  }
+  normalized += this->startSymbol->name();
+
+  // two independent 64 bit hashes
+  char hex[33];
+  snprintf(hex, sizeof(hex), "%016llx%016llx",
+           (unsigned long long)fnv1a(normalized, 0xcbf29ce484222325ULL),
+           (unsigned long long)fnv1a(normalized, 0x84222325cbf29ce4ULL));
+  return hex;
+}
+
+const string& LL1::getGrammarHash() const { return this->grammarHash; }
+
+const vector<PhaseStats>& LL1::getPhaseStats() const {
+  return this->phaseStats;
 }
 
 void LL1::printCFG() {
-  cout << "=== CFG\n";
-  cout << "Terminals: ";
+  ostream& out = *this->log;
+  out << "=== CFG\n";
+  out << "Terminals: ";
   for (Symbol* terminal : this->terminals) {
-    cout << terminal->symbol << " ";
+    out << terminal->name() << " ";
   }
-  cout << "\n";
+  out << "\n";
 
-  cout << "Non-terminals: ";
+  out << "Non-terminals: ";
   for (Symbol* nonTerminal : this->nonTerminals) {
-    cout << nonTerminal->symbol << " ";
+    out << nonTerminal->name() << " ";
   }
-  cout << "\n";
+  out << "\n";
 
-  cout << "Start symbol: " << this->startSymbol->symbol << "\n";
+  out << "Start symbol: " << this->startSymbol->name() << "\n";
 
-  cout << "\nProduction rules:\n";
-  for (auto pr : this->productionRules) {
-    for (ProductionRule* productionRule : pr.second) {
-      cout << productionRule << "\n";
+  out << "\nProduction rules:\n";
+  for (Symbol* nonTerminal : this->nonTerminals) {
+    for (ProductionRule* productionRule :
+         this->productionRules.rulesOf(nonTerminal)) {
+      out << productionRule << "\n";
     }
   }
-  cout << "===\n";
+  out << "===\n";
+}
+
+void LL1::printSymbolSet(ostream& out, const SymbolSet& symSet) const {
+  symSet.forEach([&](int id) { out << this->symbolTable.name(id) << " "; });
 }
 
 void LL1::printFirst(ostream& out) const {
-  // unordered_map<Symbol*, unordered_set<Symbol*>> firstSetsMap;
   out << "===First-sets-begin:\n";
-  for (auto symRow : this->firstSetsMap) {
-    out << symRow.first->symbol << " -> [ ";
-    for (auto firstElem : symRow.second) {
-      out << firstElem->symbol << " ";
-    }
+  for (int id = 0; id < (int)this->firstSets.size(); ++id) {
+    if (this->firstSets[id].empty()) continue;
+    out << this->symbolTable.name(id) << " -> [ ";
+    this->printSymbolSet(out, this->firstSets[id]);
     out << "]\n";
   }
   out << "===First-sets-end\n";
@@ -587,38 +2110,77 @@ void LL1::printFirst(ostream& out) const {
 
 void LL1::printFollow(ostream& out) const {
   out << "===Follow-sets-begin:\n";
-  for (auto symRow : this->followSetsMap) {
-    out << symRow.first->symbol << " -> [ ";
-    for (auto firstElem : symRow.second) {
-      out << firstElem->symbol << " ";
-    }
+  for (Symbol* nonTer : this->nonTerminals) {
+    out << nonTer->name() << " -> [ ";
+    this->printSymbolSet(out, this->followSets[nonTer->id]);
     out << "]\n";
   }
   out << "===Follow-sets-end\n";
 }
 
+void LL1::dumpAnalysis() const {
+  ostream& out = *this->log;
+  out << "First-sets: \n";
+  for (Symbol* ter : this->terminals) {
+    out << ter->name() << ": [ ";
+    this->printSymbolSet(out, this->firstSets[ter->id]);
+    out << "]\n";
+  }
+  for (Symbol* nonTer : this->nonTerminals) {
+    out << nonTer->name() << ": [ ";
+    this->printSymbolSet(out, this->firstSets[nonTer->id]);
+    out << "]\n";
+  }
+
+  out << "Follow-sets\n";
+  for (Symbol* nonTer : this->nonTerminals) {
+    out << nonTer->name() << ": [ ";
+    this->printSymbolSet(out, this->followSets[nonTer->id]);
+    out << "]\n";
+  }
+
+  out << "Parsing Table\n";
+  for (Symbol* nonTer : this->nonTerminals) {
+    for (const auto& ipSymEntry : this->parsingTable[nonTer->id]) {
+      out << "( " << nonTer->name() << ", " << ipSymEntry.first->name()
+          << ") -> ";
+      out << ipSymEntry.second->lhs->name() << " -> [ ";
+      for (Symbol* rhsSym : ipSymEntry.second->rhs) {
+        out << rhsSym->name() << " ";
+      }
+      out << "]\n";
+    }
+  }
+  if (!this->decisions.empty()) this->printLookaheadTable(out);
+  if (!this->adaptiveCells.empty()) this->printAdaptiveTable(out);
+}
+
 void LL1::setDirPath(const string& dirPath) { this->dirPath = dirPath; }
 
+string LL1::outputPath(const string& fileName) const {
+  return (this->dirPath != "" ? this->dirPath : ".") + "/" + fileName;
+}
+
 void LL1::createFirstFollowFile() const {
+  string path = this->outputPath(FIRST_FOLLOW_FILE_NAME);
   ofstream outFile;
-  if (this->dirPath != "") {
-    outFile.open(dirPath + "/" + FIRST_FOLLOW_FILE_NAME);
-  } else {
-    outFile.open("./" + FIRST_FOLLOW_FILE_NAME);
-  }
+  this->openOutputFile(outFile, path);
   this->printFirst(outFile);
   this->printFollow(outFile);
-  outFile.close();
+  outFile << GRAMMAR_HASH_TAG << " " << this->grammarHash << "\n";
+  this->closeOutputFile(outFile, path);
 }
 
 void LL1::createLL1GrammarFile() const {
+  string path = this->outputPath(LL1_GRAMMAR_FILE_NAME);
   ofstream outFile;
-  if (this->dirPath != "") {
-    outFile.open(dirPath + "/" + LL1_GRAMMAR_FILE_NAME);
-  } else {
-    outFile.open("./" + LL1_GRAMMAR_FILE_NAME);
-  }
+  this->openOutputFile(outFile, path);
+  this->printLL1Grammar(outFile);
+  outFile << GRAMMAR_HASH_TAG << " " << this->grammarHash << "\n";
+  this->closeOutputFile(outFile, path);
+}
 
+void LL1::printLL1Grammar(ostream& outFile) const {
   outFile << "===LL1-grammar-begin:\n";
   outFile << "Terminals: ";
   outFile << this->terminals.size() << " ";
@@ -638,80 +2200,203 @@ void LL1::createLL1GrammarFile() const {
   outFile << "Dollar-symbol: " << this->dollarSymbol << "\n";
   outFile << "Start-symbol: " << this->startSymbol << "\n";
 
-  int totalProdRules = 0;
-  for (auto pr : this->productionRules) {
-    totalProdRules += pr.second.size();
-  }
-
   outFile << "===Production-rules-begin:\n";
-  outFile << totalProdRules << "\n";
-  for (auto pr : this->productionRules) {
-    for (ProductionRule* productionRule : pr.second) {
+  outFile << this->productionRules.size() << "\n";
+  for (Symbol* nonTerminal : this->nonTerminals) {
+    for (ProductionRule* productionRule :
+         this->productionRules.rulesOf(nonTerminal)) {
       outFile << productionRule << "\n";
     }
   }
   outFile << "===Production-rules-end\n";
   outFile << "===LL1-grammar-end\n";
-  outFile.close();
 }
 
 void LL1::createParseTableFile() const {
+  string path = this->outputPath(PARSE_TABLE_FILE_NAME);
   ofstream outFile;
-  if (this->dirPath != "") {
-    outFile.open(dirPath + "/" + PARSE_TABLE_FILE_NAME);
-  } else {
-    outFile.open("./" + PARSE_TABLE_FILE_NAME);
-  }
+  this->openOutputFile(outFile, path);
+  this->printParseTable(outFile);
+  this->printLoopTable(outFile);
+  if (!this->decisions.empty()) this->printLookaheadTable(outFile);
+  if (!this->adaptiveCells.empty()) this->printAdaptiveTable(outFile);
+  outFile << GRAMMAR_HASH_TAG << " " << this->grammarHash << "\n";
+  this->closeOutputFile(outFile, path);
+}
+
+void LL1::printParseTable(ostream& outFile) const {
   int numEntries = 0;
-  for (auto nonTerRow : this->parsingTable) {
-    numEntries += nonTerRow.second.size();
+  for (const auto& nonTerRow : this->parsingTable) {
+    numEntries += nonTerRow.size();
   }
 
   outFile << "===Parse-table-begin:\n";
   outFile << numEntries << "\n";
-  for (auto nonTerRow : this->parsingTable) {
-    for (auto ipSymCell : nonTerRow.second) {
-      outFile << "Parse[ " << nonTerRow.first->symbol << " "
-              << ipSymCell.first->symbol << " ] : ";
+  for (Symbol* nonTer : this->nonTerminals) {
+    for (const auto& ipSymCell : this->parsingTable[nonTer->id]) {
+      outFile << "Parse[ " << nonTer->name() << " "
+              << ipSymCell.first->name() << " ] : ";
       outFile << ipSymCell.second << "\n";
     }
   }
   outFile << "===Parse-table-end\n";
-  outFile.close();
 }
 
-ostream& operator<<(ostream& os, const Symbol* sym) {
-  os << sym->symbol << " ";
-  // os << "[ " << sym->symbol << " " << sym->id << " " << sym->isTerminal
-  //    << " ] ";
-  return os;
+void LL1::printLookaheadTable(ostream& outFile) const {
+  outFile << "===LLk-table-begin: " << this->lookahead << "\n";
+  outFile << this->decisions.size() << "\n";
+  for (const LLkDecision& decision : this->decisions) {
+    outFile << "Decide[ " << decision.nonTer->name() << " "
+            << decision.ipSym->name() << " ] : "
+            << decision.alternatives.size() << "\n";
+    for (const auto& alternative : decision.alternatives) {
+      outFile << "[ ";
+      for (Symbol* sym : alternative.first) outFile << sym;
+      outFile << "] " << alternative.second << "\n";
+    }
+  }
+  outFile << "===LLk-table-end\n";
 }
 
-ostream& operator<<(ostream& os, const ProductionRule* pr) {
-  os << pr->lhs->symbol << " -> [ ";
-  for (Symbol* rhsSym : pr->rhs) {
-    os << rhsSym->symbol << " ";
+void LL1::printLoopTable(ostream& outFile) const {
+  vector<Symbol*> loops = this->loopNonTerminals();
+  if (loops.empty()) return;
+  outFile << "===Loop-table-begin:\n";
+  outFile << loops.size() << "\n";
+  for (Symbol* loop : loops) outFile << "Loop[ " << loop->name() << " ]\n";
+  outFile << "===Loop-table-end\n";
+}
+
+void LL1::printAdaptiveTable(ostream& outFile) const {
+  outFile << "===Adaptive-table-begin:\n";
+  outFile << this->adaptiveCells.size() << "\n";
+  for (const LL1Conflict& cell : this->adaptiveCells) {
+    outFile << "Adaptive[ " << cell.nonTer->name() << " "
+            << cell.ipSym->name() << " ]\n";
+  }
+  outFile << "===Adaptive-table-end\n";
+}
+
+ParserTables LL1::getParserTables() const {
+  ParserTables tables;
+  // index[id] = position of the symbol in tables.symbols
+  vector<int> index(this->totNumSyms, -1);
+  auto addSymbol = [&](Symbol* sym) {
+    index[sym->id] = tables.symbols.size();
+    tables.symbols.push_back({string(sym->name()), sym->isTerminal});
+  };
+  for (Symbol* terminal : this->terminals) addSymbol(terminal);
+  for (Symbol* nonTer : this->nonTerminals) addSymbol(nonTer);
+  addSymbol(this->epsSymbol);
+  addSymbol(this->dollarSymbol);
+  tables.startSymbol = index[this->startSymbol->id];
+  tables.epsSymbol = index[this->epsSymbol->id];
+  tables.dollarSymbol = index[this->dollarSymbol->id];
+
+  unordered_map<const ProductionRule*, int> ruleIndex;
+  for (Symbol* nonTer : this->nonTerminals) {
+    for (ProductionRule* pr : this->productionRules.rulesOf(nonTer)) {
+      ruleIndex[pr] = tables.rules.size();
+      ParserTables::Rule rule;
+      rule.lhs = index[pr->lhs->id];
+      for (Symbol* sym : pr->rhs) rule.rhs.push_back(index[sym->id]);
+      tables.rules.push_back(move(rule));
+    }
+  }
+  for (Symbol* nonTer : this->nonTerminals) {
+    for (const auto& [ipSym, pr] : this->parsingTable[nonTer->id]) {
+      tables.parseTable.push_back(
+          {index[nonTer->id], index[ipSym->id], ruleIndex.at(pr)});
+    }
+  }
+  for (Symbol* loop : this->loopNonTerminals()) {
+    tables.loopNonTerminals.push_back(index[loop->id]);
+  }
+  tables.lookahead = this->decisions.empty() ? 1 : this->lookahead;
+  for (const LLkDecision& decision : this->decisions) {
+    ParserTables::Decision tableDecision;
+    tableDecision.nonTer = index[decision.nonTer->id];
+    tableDecision.ipSym = index[decision.ipSym->id];
+    for (const auto& [str, pr] : decision.alternatives) {
+      vector<int> lookaheadIds;
+      for (Symbol* sym : str) lookaheadIds.push_back(index[sym->id]);
+      tableDecision.alternatives.push_back({lookaheadIds, ruleIndex.at(pr)});
+    }
+    tables.decisions.push_back(move(tableDecision));
+  }
+  for (const LL1Conflict& cell : this->adaptiveCells) {
+    tables.adaptiveCells.push_back(
+        {index[cell.nonTer->id], index[cell.ipSym->id]});
   }
-  os << "] ";
-  return os;
+  return tables;
 }
 
-ostream& operator<<(ostream& os, stack<Symbol*> st) {
-  os << "[ ";
-  while (!st.empty()) {
-    os << st.top()->symbol << " ";
-    st.pop();
+void LL1::createPluginFile(const string& path) const {
+  string sourcePath = path + ".cpp";
+  ofstream outFile;
+  this->openOutputFile(outFile, sourcePath);
+  try {
+    writePluginSource(this->getParserTables(), this->grammarHash, outFile);
+  } catch (string message) {
+    this->fail(message);
+  }
+  this->closeOutputFile(outFile, sourcePath);
+  try {
+    buildPlugin(sourcePath, path);
+  } catch (string message) {
+    this->fail(message);
   }
-  os << "] ";
-  return os;
 }
 
-ostream& operator<<(ostream& os,
-                    const pair<vector<string>, pair<int, int>>& vec) {
-  os << "[ ";
-  for (int i = vec.second.first; i < vec.second.second; ++i) {
-    os << vec.first[i] << " ";
+void LL1::createStateFile(const string& path) const {
+  ofstream outFile;
+  this->openOutputFile(outFile, path);
+  outFile << "===LL1-state-begin: " << GENERATOR_VERSION << "\n";
+  this->printLL1Grammar(outFile);
+  this->printFirst(outFile);
+  this->printFollow(outFile);
+  this->printParseTable(outFile);
+  outFile << "===LL1-state-end\n";
+  this->closeOutputFile(outFile, path);
+}
+
+void LL1::createStatsFile(const string& path) const {
+  // one object per phase, in the order they ran; the names are identifiers
+  // and the hash is hex, so nothing needs escaping
+  ofstream outFile;
+  this->openOutputFile(outFile, path);
+  int numThreads = (this->threadPool != nullptr) ? this->threadPool->size() : 1;
+  outFile << "{\n";
+  outFile << "  \"generator\": \"" << GENERATOR_VERSION << "\",\n";
+  outFile << "  \"grammarHash\": \"" << this->grammarHash << "\",\n";
+  outFile << "  \"threads\": " << numThreads << ",\n";
+  outFile << "  \"phases\": [";
+  double totalMilliseconds = 0;
+  long long totalAllocations = 0, totalBytes = 0;
+  for (int i = 0; i < (int)this->phaseStats.size(); ++i) {
+    const PhaseStats& stats = this->phaseStats[i];
+    totalMilliseconds += stats.milliseconds;
+    totalAllocations += stats.numAllocations;
+    totalBytes += stats.bytesAllocated;
+    outFile << (i == 0 ? "\n" : ",\n");
+    outFile << "    {\"name\": \"" << stats.name << "\", "
+            << "\"wallMs\": " << stats.milliseconds << ", "
+            << "\"peakRssDeltaKb\": " << stats.peakRssDeltaKb << ",\n"
+            << "     \"allocations\": " << stats.numAllocations << ", "
+            << "\"allocatedBytes\": " << stats.bytesAllocated << ", "
+            << "\"iterations\": " << stats.numIterations << ",\n"
+            << "     \"rules\": [" << stats.rulesBefore << ", "
+            << stats.rulesAfter << "], "
+            << "\"nonTerminals\": [" << stats.nonTersBefore << ", "
+            << stats.nonTersAfter << "], "
+            << "\"symbols\": [" << stats.symbolsBefore << ", "
+            << stats.symbolsAfter << "]}";
   }
-  os << "] ";
-  return os;
-}
\ No newline at end of file
+  outFile << "\n  ],\n";
+  outFile << "  \"total\": {\"wallMs\": " << totalMilliseconds << ", "
+          << "\"peakRssKb\": " << peakRssKb() << ",\n"
+          << "            \"allocations\": " << totalAllocations << ", "
+          << "\"allocatedBytes\": " << totalBytes << "}\n";
+  outFile << "}\n";
+  this->closeOutputFile(outFile, path);
+}
@@ -1,20 +1,104 @@
 #ifndef __LL1_HPP__
 #define __LL1_HPP__
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <deque>
 #include <fstream>
+#include <functional>
 #include <iostream>
-#include <stack>
+#include <map>
+#include <memory>
+#include <queue>
 #include <string>
+#include <tuple>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "../Common/ParserTables.hpp"
 #include "../Common/constants.hpp"
 #include "../Common/structs.hpp"
+#include "CompileStats.hpp"
+#include "GrammarReader.hpp"
+#include "LookaheadTrie.hpp"
+#include "PluginWriter.hpp"
+#include "RuleTable.hpp"
+#include "SymbolSet.hpp"
+#include "ThreadPool.hpp"
 
 using namespace std;
 
+struct LL1Options {
+  // > 1 -> compute first/follow sets and the parsing table on a thread pool;
+  // the sets and the table are the same as with a single thread
+  int numThreads;
+  // expand leading non-terminals of rules while left factoring, if that
+  // exposes a prefix shared with another rule of the same non-terminal
+  bool expandLeadingNonTers;
+  // file to read the grammar from ("" -> prompt for it on cin)
+  string grammarPath;
+  // dump the CFG, first/follow sets and the parsing table on cout
+  bool verbose;
+  // k > 1 -> cells of the parsing table claimed by several rules are settled
+  // by looking at up to k input symbols (strong LL(k)) instead of failing
+  int lookahead;
+  // cells still claimed by several rules (after lookahead, if any) are left
+  // to adaptive prediction by the parser instead of failing
+  bool adaptive;
+  // drop useless non-terminals and inline unit and single-use productions
+  // after rewriting the grammar (see LL1::minimizeGrammar)
+  bool minimize;
+  // where messages, dumps and errors are printed
+  ostream* log;
+  // false -> errors are printed and thrown (as a string) instead of exiting
+  bool exitOnError;
+  // record the cost of every phase (see LL1::createStatsFile)
+  bool collectStats;
+  LL1Options() {
+    this->numThreads = 1;
+    this->expandLeadingNonTers = false;
+    this->grammarPath = "";
+    this->verbose = true;
+    this->lookahead = 1;
+    this->adaptive = false;
+    this->minimize = false;
+    this->log = &cout;
+    this->exitOnError = true;
+    this->collectStats = false;
+  }
+};
+
+// Cell of the parsing table claimed by more than one production rule
+struct LL1Conflict {
+  Symbol* nonTer;
+  Symbol* ipSym;
+  // FIRST/FIRST if ipSym starts two of the rules, FIRST/FOLLOW if it is only
+  // in the predict sets through the follow set of a nullable rule
+  bool isFirstFirst;
+  vector<ProductionRule*> rules;
+};
+
+// Cell of the parsing table settled by looking further ahead than one symbol
+struct LLkDecision {
+  Symbol* nonTer;
+  Symbol* ipSym;
+  // (shortest lookahead string telling the rules apart, rule to apply); every
+  // string starts with ipSym, sorted by symbol ids
+  vector<pair<vector<Symbol*>, ProductionRule*>> alternatives;
+};
+
+// Alternatives of a rhs being read: the rhs itself, or an EBNF group opened
+// inside it
+struct RhsGroup {
+  // EBNF_REPEAT_BEGIN, EBNF_OPTIONAL_BEGIN, or "[" for the rhs itself
+  string opener;
+  vector<vector<Symbol*>> alternatives;
+};
+
 class LL1 {
   int totNumSyms;
   Symbol* startSymbol;
@@ -22,59 +106,218 @@ class LL1 {
   Symbol* dollarSymbol;
   vector<Symbol*> terminals;
   vector<Symbol*> nonTerminals;
+  // every symbol (name, terminal flag), indexed by its id
+  SymbolTable symbolTable;
+  // production rules, grouped by the symbol on their lhs
+  RuleTable productionRules;
 
-  // map symbol-strings to corresponding symbol-pointer
-  unordered_map<string, Symbol*> symToPtr;
-  // map (symbol-ptr) to (production rules with that symbol on lhs)
-  unordered_map<Symbol*, unordered_set<ProductionRule*>> productionRules;
-
-  // First and Follow sets
-  unordered_map<Symbol*, unordered_set<Symbol*>> firstSetsMap;
-  unordered_map<Symbol*, unordered_set<Symbol*>> followSetsMap;
+  // First and Follow sets, indexed by symbol id
+  vector<SymbolSet> firstSets;
+  vector<SymbolSet> followSets;
 
   // Parsing table:
   //
-  //    map (current non-terminal ->
+  //    parsingTable[id of the current non-terminal] =
   //          [
-  //              map (current input symbol ->
-  //                [
-  //                    production rule to be used for the pair
-  //                    {current non-terminal, current-input-symbol}
-  //                ]
-  //              )
+  //              (current input symbol, production rule to be used for the
+  //               pair {current non-terminal, current-input-symbol})
+  //              ... sorted by the id of the input symbol
   //          ]
-  //        )
-  unordered_map<Symbol*, unordered_map<Symbol*, ProductionRule*>> parsingTable;
+  vector<vector<pair<Symbol*, ProductionRule*>>> parsingTable;
+  // filled by isLL1, in order of nonTerminals and input symbol id
+  vector<LL1Conflict> conflicts;
+  // maximum number of input symbols a decision may look at
+  int lookahead;
+  // one per conflict of the LL(1) table (only with lookahead > 1); the cells
+  // they settle are left out of parsingTable, decidedCells[nonTer->id] has
+  // their input symbols
+  vector<LLkDecision> decisions;
+  vector<SymbolSet> decidedCells;
+  bool adaptive;
+  // conflicts left to adaptive prediction (also in decidedCells)
+  vector<LL1Conflict> adaptiveCells;
 
   // Relative path of grammar's folder from current directory
   string dirPath;
 
-  void computeFirstForSym(Symbol* sym);
+  // workers for the parallel phases (nullptr -> every phase runs serially)
+  ThreadPool* threadPool;
+  bool expandLeadingNonTers;
+  bool minimize;
+  bool verbose;
+  ostream* log;
+  bool exitOnError;
+  bool collectStats;
+  // one per phase run so far, if collectStats is set
+  vector<PhaseStats> phaseStats;
+  // iterations of the fixed points of the running phase (see PhaseStats)
+  mutable atomic<long long> numIterations;
+  // hash of the grammar as read (see hashGrammar)
+  string grammarHash;
+
+  // prints the error on log, then exits or throws it (see LL1Options)
+  [[noreturn]] void fail(const string& message) const;
+  // opens path for writing, fails if it can't be created
+  void openOutputFile(ofstream& outFile, const string& path) const;
+  // closes outFile, fails if anything written to path was lost
+  void closeOutputFile(ofstream& outFile, const string& path) const;
+  // fileName in the directory set by setDirPath (default: .)
+  string outputPath(const string& fileName) const;
+  // runs phase, recording its cost in phaseStats if collectStats is set
+  void runPhase(const string& name, const function<void()>& phase);
+  // creates a symbol with the next free id
+  Symbol* addSymbol(string_view name, bool isTerminal);
+  // adds a token of the rhs of a rule of lhs (a symbol, "|", or an EBNF
+  // group bracket) to groups, the stack of groups open while reading it;
+  // returns an error message, "" if there is none
+  string addRhsToken(Symbol* lhs, vector<RhsGroup>& groups, string_view token);
+  // non-terminal deriving the EBNF group just closed, with its rules
+  Symbol* addEbnfGroup(Symbol* lhs, const RhsGroup& group);
+  // non-terminals whose rules are all "R -> [ ε ]" or "R -> [ ... R ]" with
+  // R only at the end: the parser runs them as loops
+  vector<Symbol*> loopNonTerminals() const;
+  // users[B->id] = non-terminals having a production rule with B on the rhs
+  // (first of B may flow into first of each of them)
+  vector<vector<Symbol*>> firstUsers() const;
+  // adds first of every production rule of sym to first(sym), returns true if
+  // first(sym) grew
+  bool computeFirstForSym(Symbol* sym);
+  // runs computeFirstForSym over nonTers till none of their sets change;
+  // users[id] lists the non-terminals having that symbol on a rhs, only those
+  // with componentOf[id] == component are queued again
+  void computeFirstFixedPoint(const vector<Symbol*>& nonTers,
+                              const vector<vector<Symbol*>>& users,
+                              const vector<int>& componentOf, int component);
+  // adds what a single production rule contributes to the follow sets and
+  // records which follow sets contain Follow(pr->lhs)
+  void computeFollowOfRule(const ProductionRule* pr, vector<SymbolSet>& follow,
+                           vector<vector<Symbol*>>& dependents) const;
+  void propagateFollow(const vector<vector<Symbol*>>& dependents);
+  void computeFollowParallel(vector<vector<Symbol*>>& dependents);
+  // symbols that can appear first in a string derived from sym, by following
+  // the first rhs symbol of each rule (epsilon is not looked through)
+  const SymbolSet& leadingSymbols(Symbol* sym,
+                                  unordered_map<Symbol*, SymbolSet>& memo);
+  void expandLeadingNonTerminals(Symbol* nonTer);
+  // order in which Paull's algorithm rewrites the members of a left-recursive
+  // component of the left-corner graph (see eliminateLeftRecursion), and
+  // the estimated number of rules of the component once rewritten
+  vector<Symbol*> substitutionOrder(const vector<Symbol*>& component,
+                                    const vector<vector<Symbol*>>& leftCorners,
+                                    const vector<int>& position,
+                                    long long& numRules) const;
+  // removes the left recursion of a component with the left-corner
+  // transform: size(kept) times its number of rules, at most. Members not
+  // in kept must only be used as the leading symbol of members' rules.
+  void leftCornerTransform(const vector<Symbol*>& component,
+                           const vector<Symbol*>& kept);
+  // Paull's algorithm over the non-terminals of order only; rank is -1 for
+  // every symbol on entry and on return
+  void eliminateLeftRecursionIn(const vector<Symbol*>& order,
+                                vector<int>& rank);
+  // A -> A a | b   becomes   A -> b A_', A_' -> a A_' | ε
+  void removeDirectLeftRecursion(Symbol* nonTer);
+  // moves the rules of nonTer not led by a member of order (rank >= 0) to a
+  // new non-terminal nonTer_base, if there are several and nonTer also has
+  // rules led by a member
+  void splitBaseRules(Symbol* nonTer, const vector<int>& rank);
+  // removes non-terminals deriving no terminal string or not reachable from
+  // the start symbol, with the rules using them
+  void removeUselessNonTerminals();
+  // replaces uses of non-terminals by their rules where that keeps the
+  // grammar LL(1) (see minimizeGrammar), returns true if anything changed
+  bool inlineProductions();
+  // size of the parsing table and the average number of rules applied per
+  // input symbol before it is matched, from the current first/follow sets
+  void measureTable(int& numEntries, double& expansionsPerSym) const;
+  // first(rhs) without eps into firstOfRhs, returns true if rhs derives eps
+  // (the predict set then also has Follow(pr->lhs))
+  bool firstOfRule(const ProductionRule* pr, SymbolSet& firstOfRhs) const;
+  void findConflictsInRow(Symbol* nonTer, vector<LL1Conflict>& found) const;
+  // FIRST_k of syms[from..], given FIRST_k of every symbol
+  LookaheadTrie firstKOfString(const vector<Symbol*>& syms, int from,
+                               const vector<LookaheadTrie>& firstK) const;
+  // FIRST_k and FOLLOW_k (k = lookahead) of every symbol, indexed by id
+  void computeFirstK(vector<LookaheadTrie>& firstK) const;
+  void computeFollowK(const vector<LookaheadTrie>& firstK,
+                      vector<LookaheadTrie>& followK) const;
+  // turns every conflict it can into a decision on up to k input symbols and
+  // leaves the others in conflicts; unless adaptive, throws
+  // NOT_LLK_EXCEPTION (after listing them) if there are any
+  void buildLookaheadDecisions();
+  // moves the remaining conflicts to adaptiveCells
+  void markAdaptiveCells();
+  void buildParsingTableRow(Symbol* nonTer,
+                            vector<pair<Symbol*, ProductionRule*>>& row);
+  // rule at parsingTable[nonTer][ipSym] (nullptr -> empty cell)
+  ProductionRule* parsingTableEntry(const Symbol* nonTer,
+                                    const Symbol* ipSym) const;
+  void printSymbolSet(ostream& out, const SymbolSet& symSet) const;
   void printFirst(ostream& out) const;
   void printFollow(ostream& out) const;
+  void printLL1Grammar(ostream& out) const;
+  void printParseTable(ostream& out) const;
+  void printLookaheadTable(ostream& out) const;
+  void printAdaptiveTable(ostream& out) const;
+  void printLoopTable(ostream& out) const;
+  // prints first/follow sets and the parsing table on cout
+  void dumpAnalysis() const;
+  // recomputes only the sets and table rows the changes since the compilation
+  // saved in statePath can reach, false if the state can't be used
+  bool compileIncrementally(const string& statePath);
+  // hex digest of the normalized grammar, the generator version and the
+  // options affecting the generated files
+  string hashGrammar() const;
 
  public:
-  LL1();
+  // reads the grammar; nothing is computed till compile()
+  LL1(const LL1Options& options = LL1Options());
+  ~LL1();
+  // rewrites the grammar into LL(1) form and builds first/follow sets and the
+  // parsing table, fails if the grammar is not LL(1) (or LL(k), with
+  // lookahead k > 1) unless adaptive; given the state file of an earlier
+  // compilation, only what the changes affect is recomputed
+  void compile(const string& statePath = "");
+  const string& getGrammarHash() const;
+  // phases run so far with LL1Options::collectStats set
+  const vector<PhaseStats>& getPhaseStats() const;
+  // size of the grammar and of its tables as compiled so far; conflicts are
+  // the cells of the parsing table still claimed by several rules
+  int numNonTerminals() const;
+  int numProductionRules() const;
+  int numTableEntries() const;
+  int numConflicts() const;
   void eliminateLeftRecursion();
   void leftFactor();
+  // shrinks the rewritten grammar and reports on cout by how much
+  void minimizeGrammar();
   void computeFirst();
   void computeFollow();
+  // finds every conflict of the parsing table (first/follow sets must be
+  // computed), returns true if there is none
   bool isLL1();
+  void printConflicts(ostream& out) const;
   void buildParsingTable();
-  bool predictiveParsing(const vector<string>& tokens) const;
-  void readCFG();
+  // reads the grammar from in, printing the prompts if interactive is set
+  void readCFG(istream& in, bool interactive);
+  // reads the grammar (same format as readCFG) from a file in one pass,
+  // throws "<path>:<line>:<column>: <message>" on malformed input
+  void readCFGFile(const string& path);
   void printCFG();
   void setDirPath(const string& dirPath);
   void createFirstFollowFile() const;
   void createLL1GrammarFile() const;
   void createParseTableFile() const;
+  // the compiled grammar and tables, for an LL1Parser in this process (the
+  // same parser as the one reading the files above)
+  ParserTables getParserTables() const;
+  // writes the source of a grammar plugin to path + ".cpp" and builds it into
+  // the shared object path (see PluginWriter.hpp); LL(1) tables only
+  void createPluginFile(const string& path) const;
+  // saves everything compile(statePath) needs to path
+  void createStateFile(const string& path) const;
+  // saves the cost of every phase recorded so far to path, as JSON
+  void createStatsFile(const string& path) const;
 };
 
-// Operator-overloadings for easy printing
-// print stack
-ostream& operator<<(ostream& os, stack<Symbol*> st);
-// print vector from pair.second.first to pair.second.second
-// (pair.second.first inclusive and pair.second.second exclusive)
-ostream& operator<<(ostream& os,
-                    const pair<vector<string>, pair<int, int>>& vec);
 #endif
\ No newline at end of file
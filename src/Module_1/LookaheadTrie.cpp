@@ -0,0 +1,102 @@
+#include "LookaheadTrie.hpp"
+
+#include <algorithm>
+#include <climits>
+
+LookaheadTrie::LookaheadTrie() { this->nodes.emplace_back(); }
+
+int LookaheadTrie::childOf(int node, int symId) const {
+  const auto& children = this->nodes[node].children;
+  auto it = lower_bound(children.begin(), children.end(),
+                        make_pair(symId, INT_MIN));
+  return (it != children.end() && it->first == symId) ? it->second : -1;
+}
+
+int LookaheadTrie::addChild(int node, int symId, bool& grew) {
+  int child = this->childOf(node, symId);
+  if (child >= 0) return child;
+  child = this->nodes.size();
+  this->nodes.emplace_back();
+  auto& children = this->nodes[node].children;
+  children.insert(lower_bound(children.begin(), children.end(),
+                              make_pair(symId, INT_MIN)),
+                  {symId, child});
+  grew = true;
+  return child;
+}
+
+bool LookaheadTrie::graft(int node, const LookaheadTrie& other, int otherNode,
+                          int depthLeft) {
+  bool grew = false;
+  const Node& from = other.nodes[otherNode];
+  // out of room: every string below otherNode is cut right here
+  if (from.isEnd || (depthLeft == 0 && !from.children.empty())) {
+    grew |= !this->nodes[node].isEnd;
+    this->nodes[node].isEnd = true;
+  }
+  if (depthLeft == 0) return grew;
+  for (const auto& child : from.children) {
+    int next = this->addChild(node, child.first, grew);
+    grew |= this->graft(next, other, child.second, depthLeft - 1);
+  }
+  return grew;
+}
+
+bool LookaheadTrie::empty() const {
+  return !this->nodes[0].isEnd && this->nodes[0].children.empty();
+}
+
+bool LookaheadTrie::insert(const vector<int>& str) {
+  bool grew = false;
+  int node = 0;
+  for (int symId : str) node = this->addChild(node, symId, grew);
+  grew |= !this->nodes[node].isEnd;
+  this->nodes[node].isEnd = true;
+  return grew;
+}
+
+bool LookaheadTrie::unionWith(const LookaheadTrie& other) {
+  return this->graft(0, other, 0, INT_MAX);
+}
+
+void LookaheadTrie::concatFrom(int node, int depth, int lastSymId,
+                               int resultNode, const LookaheadTrie& other,
+                               int k, int stopSymId,
+                               LookaheadTrie& result) const {
+  if (this->nodes[node].isEnd) {
+    if (depth == k || (depth > 0 && lastSymId == stopSymId)) {
+      result.nodes[resultNode].isEnd = true;
+    } else {
+      result.graft(resultNode, other, 0, k - depth);
+    }
+  }
+  for (const auto& child : this->nodes[node].children) {
+    bool grew = false;
+    int next = result.addChild(resultNode, child.first, grew);
+    this->concatFrom(child.second, depth + 1, child.first, next, other, k,
+                     stopSymId, result);
+  }
+}
+
+LookaheadTrie LookaheadTrie::concat(const LookaheadTrie& other, int k,
+                                    int stopSymId) const {
+  LookaheadTrie result;
+  this->concatFrom(0, 0, -1, 0, other, k, stopSymId, result);
+  return result;
+}
+
+bool LookaheadTrie::hasOpenString(int k, int stopSymId) const {
+  bool isOpen = false;
+  this->forEach([&](const vector<int>& str) {
+    isOpen |= ((int)str.size() < k &&
+               (str.empty() || str.back() != stopSymId));
+  });
+  return isOpen;
+}
+
+bool LookaheadTrie::operator==(const LookaheadTrie& other) const {
+  vector<vector<int>> mine, theirs;
+  this->forEach([&](const vector<int>& str) { mine.push_back(str); });
+  other.forEach([&](const vector<int>& str) { theirs.push_back(str); });
+  return mine == theirs;
+}
@@ -0,0 +1,62 @@
+#ifndef __LOOKAHEAD_TRIE_HPP__
+#define __LOOKAHEAD_TRIE_HPP__
+
+#include <vector>
+
+using namespace std;
+
+// Set of lookahead strings (sequences of at most k symbol ids), stored as a
+// trie so that strings sharing a prefix share its nodes. Used for FIRST_k and
+// FOLLOW_k, where the same few leading symbols repeat over and over.
+class LookaheadTrie {
+  struct Node {
+    // (symbol id, child node), sorted by symbol id
+    vector<pair<int, int>> children;
+    // true if a string ends at this node
+    bool isEnd = false;
+  };
+  // nodes[0] is the root (the empty string ends there)
+  vector<Node> nodes;
+
+  int childOf(int node, int symId) const;
+  int addChild(int node, int symId, bool& grew);
+  // adds the strings of other below otherNode under node, cut after
+  // depthLeft symbols; returns true if the set grew
+  bool graft(int node, const LookaheadTrie& other, int otherNode,
+             int depthLeft);
+  void concatFrom(int node, int depth, int lastSymId, int resultNode,
+                  const LookaheadTrie& other, int k, int stopSymId,
+                  LookaheadTrie& result) const;
+  template <typename Fn>
+  void forEachFrom(int node, vector<int>& str, Fn& fn) const {
+    if (this->nodes[node].isEnd) fn(str);
+    for (const auto& child : this->nodes[node].children) {
+      str.push_back(child.first);
+      this->forEachFrom(child.second, str, fn);
+      str.pop_back();
+    }
+  }
+
+ public:
+  // the empty set
+  LookaheadTrie();
+  bool empty() const;
+  // returns true if str was not in the set yet
+  bool insert(const vector<int>& str);
+  // returns true if the set grew
+  bool unionWith(const LookaheadTrie& other);
+  // { first k symbols of ab : a in this set, b in other }; strings already k
+  // long or ending with stopSymId (the end marker) are not extended
+  LookaheadTrie concat(const LookaheadTrie& other, int k, int stopSymId) const;
+  // true if some string of the set is shorter than k and could be extended
+  bool hasOpenString(int k, int stopSymId) const;
+  // calls fn(str) for every string, in lexicographic order of symbol ids
+  template <typename Fn>
+  void forEach(Fn fn) const {
+    vector<int> str;
+    this->forEachFrom(0, str, fn);
+  }
+  bool operator==(const LookaheadTrie& other) const;
+};
+
+#endif
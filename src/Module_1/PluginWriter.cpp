@@ -0,0 +1,155 @@
+#include "PluginWriter.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstdlib>
+#include <map>
+#include <sstream>
+#include <vector>
+
+#include "../Common/GrammarPlugin.hpp"
+#include "../Common/constants.hpp"
+
+static string quote(const string& str) {
+  string quoted = "\"";
+  for (char c : str) {
+    if (c == '"' || c == '\\') quoted += '\\';
+    quoted += c;
+  }
+  return quoted + "\"";
+}
+
+void writePluginSource(const ParserTables& tables, const string& grammarHash,
+                       ostream& out) {
+  if (!tables.decisions.empty() || !tables.adaptiveCells.empty()) {
+    throw string("a plugin needs an LL(1) table (no -k or -a cells)");
+  }
+  const auto& symbols = tables.symbols;
+  auto ruleText = [&](const ParserTables::Rule& rule) {
+    string text = symbols[rule.lhs].first + " -> [ ";
+    for (int sym : rule.rhs) text += symbols[sym].first + " ";
+    return text + "]";
+  };
+
+  out << "// Grammar plugin generated by " << GENERATOR_VERSION
+      << " (see GrammarPlugin.hpp), do not edit\n";
+  out << "#include <vector>\n\n";
+  out << "namespace {\n";
+  out << "const int NUM_SYMBOLS = " << symbols.size() << ";\n";
+  out << "const int START = " << tables.startSymbol << ";\n";
+  out << "const int DOLLAR = " << tables.dollarSymbol << ";\n";
+  out << "const char* const symbolNames[] = {\n";
+  for (const auto& symbol : symbols) {
+    out << "    " << quote(symbol.first) << ",\n";
+  }
+  out << "};\n";
+  out << "const unsigned char isTerminal[] = {";
+  for (int i = 0; i < (int)symbols.size(); ++i) {
+    out << (i % 16 == 0 ? "\n    " : " ") << symbols[i].second << ",";
+  }
+  out << "\n};\n";
+  out << "}  // namespace\n\n";
+
+  out << "extern \"C\" {\n";
+  out << "unsigned ll1PluginAbiVersion(void) { return "
+      << GRAMMAR_PLUGIN_ABI_VERSION << "; }\n";
+  out << "const char* ll1PluginGenerator(void) { return "
+      << quote(GENERATOR_VERSION) << "; }\n";
+  out << "const char* ll1PluginGrammarHash(void) { return "
+      << quote(grammarHash) << "; }\n";
+  out << "int ll1PluginNumSymbols(void) { return NUM_SYMBOLS; }\n";
+  out << "const char* ll1PluginSymbolName(int id) {\n"
+      << "  return (id >= 0 && id < NUM_SYMBOLS) ? symbolNames[id] : nullptr;\n"
+      << "}\n";
+  out << "int ll1PluginIsTerminal(int id) {\n"
+      << "  return id >= 0 && id < NUM_SYMBOLS && isTerminal[id];\n"
+      << "}\n\n";
+
+  // the input symbols of every cell, grouped by the rule they predict; names
+  // in comments are quoted, a trailing backslash would continue the comment
+  map<int, map<int, vector<int>>> cells;
+  for (const ParserTables::Cell& cell : tables.parseTable) {
+    cells[cell.nonTer][cell.rule].push_back(cell.ipSym);
+  }
+  out << "int ll1PluginParse(const int* tokens, int numTokens) {\n"
+      << "  std::vector<int> stack{DOLLAR, START};\n"
+      << "  int next = 0;\n"
+      << "  while (!stack.empty()) {\n"
+      << "    int top = stack.back();\n"
+      << "    stack.pop_back();\n"
+      << "    int token = (next < numTokens) ? tokens[next] : DOLLAR;\n"
+      << "    if (token < 0 || token >= NUM_SYMBOLS || !isTerminal[token]) {\n"
+      << "      return 0;\n"
+      << "    }\n"
+      << "    if (isTerminal[top]) {\n"
+      << "      if (top != token) return 0;\n"
+      << "      if (top == DOLLAR) return next == numTokens;\n"
+      << "      ++next;\n"
+      << "      continue;\n"
+      << "    }\n"
+      << "    switch (top) {\n";
+  for (const auto& [nonTer, rules] : cells) {
+    out << "      case " << nonTer << ":  // " << quote(symbols[nonTer].first)
+        << "\n"
+        << "        switch (token) {\n";
+    for (const auto& [rule, ipSyms] : rules) {
+      for (int ipSym : ipSyms) {
+        out << "          case " << ipSym << ":  // "
+            << quote(symbols[ipSym].first) << "\n";
+      }
+      const ParserTables::Rule& pr = tables.rules[rule];
+      out << "            // " << ruleText(pr) << "\n";
+      for (auto it = pr.rhs.rbegin(); it != pr.rhs.rend(); ++it) {
+        if (*it == tables.epsSymbol) continue;
+        out << "            stack.push_back(" << *it << ");\n";
+      }
+      out << "            break;\n";
+    }
+    out << "          default:\n"
+        << "            return 0;\n"
+        << "        }\n"
+        << "        break;\n";
+  }
+  out << "      default:\n"
+      << "        return 0;\n"
+      << "    }\n"
+      << "  }\n"
+      << "  return 0;\n"
+      << "}\n";
+  out << "}\n";
+}
+
+void buildPlugin(const string& sourcePath, const string& path) {
+  // run without a shell, so that no path is ever parsed as a command; $CXX
+  // may hold arguments (e.g. "ccache g++"), split on white space
+  const char* compiler = getenv("CXX");
+  vector<string> args;
+  istringstream compilerWords(compiler != nullptr ? compiler : "c++");
+  for (string word; compilerWords >> word;) args.push_back(word);
+  if (args.empty()) args.push_back("c++");
+  args.insert(args.end(), {"-O2", "-shared", "-fPIC", "-o", path, sourcePath});
+
+  string command;
+  vector<char*> argv;
+  for (string& arg : args) {
+    command += (command.empty() ? "" : " ") + arg;
+    argv.push_back(&arg[0]);
+  }
+  argv.push_back(nullptr);
+  cout.flush();
+  pid_t pid = fork();
+  if (pid < 0) throw "cannot run: " + command;
+  if (pid == 0) {
+    execvp(argv[0], argv.data());
+    _exit(127);
+  }
+  int status;
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) throw "cannot run: " + command;
+  }
+  if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    throw "failed: " + command;
+  }
+}
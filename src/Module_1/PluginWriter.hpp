@@ -0,0 +1,23 @@
+#ifndef __PLUGIN_WRITER_HPP__
+#define __PLUGIN_WRITER_HPP__
+
+#include <iostream>
+#include <string>
+
+#include "../Common/ParserTables.hpp"
+
+using namespace std;
+
+// Grammar plugins (see GrammarPlugin.hpp): the parser of one grammar as C++
+// source, every cell of the parsing table a case of a switch, built into a
+// shared object.
+//
+// writes the source of the plugin of tables; throws a message (string)
+// unless tables are LL(1) (no decisions or adaptive cells)
+void writePluginSource(const ParserTables& tables, const string& grammarHash,
+                       ostream& out);
+// builds the shared object path from sourcePath with $CXX (default: c++),
+// run without a shell; throws a message (string) if that fails
+void buildPlugin(const string& sourcePath, const string& path);
+
+#endif
@@ -0,0 +1,40 @@
+#include "RuleArena.hpp"
+
+#include <new>
+
+RuleArena::RuleArena() { this->numUsedInLast = BLOCK_SIZE; }
+
+RuleArena::~RuleArena() {
+  // released slots still hold a (cleared) rule, so every constructed slot is
+  // destroyed
+  for (int b = 0; b < (int)this->blocks.size(); ++b) {
+    int numUsed =
+        (b + 1 == (int)this->blocks.size()) ? this->numUsedInLast : BLOCK_SIZE;
+    for (int k = 0; k < numUsed; ++k) this->blocks[b][k].~ProductionRule();
+    ::operator delete(this->blocks[b]);
+  }
+}
+
+ProductionRule* RuleArena::create(Symbol* lhs, vector<Symbol*>&& rhs) {
+  if (!this->freeSlots.empty()) {
+    ProductionRule* pr = this->freeSlots.back();
+    this->freeSlots.pop_back();
+    pr->id = -1;
+    pr->lhs = lhs;
+    pr->rhs = move(rhs);
+    return pr;
+  }
+  if (this->numUsedInLast == BLOCK_SIZE) {
+    this->blocks.push_back(static_cast<ProductionRule*>(
+        ::operator new(BLOCK_SIZE * sizeof(ProductionRule))));
+    this->numUsedInLast = 0;
+  }
+  ProductionRule* slot = this->blocks.back() + this->numUsedInLast++;
+  return new (slot) ProductionRule(lhs, move(rhs));
+}
+
+void RuleArena::release(ProductionRule* pr) {
+  vector<Symbol*>().swap(pr->rhs);
+  pr->lhs = nullptr;
+  this->freeSlots.push_back(pr);
+}
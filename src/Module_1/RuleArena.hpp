@@ -0,0 +1,33 @@
+#ifndef __RULE_ARENA_HPP__
+#define __RULE_ARENA_HPP__
+
+#include <vector>
+
+#include "../Common/structs.hpp"
+
+using namespace std;
+
+// Storage of the production rules of a RuleTable.
+//
+// Rules are constructed in place in blocks of BLOCK_SIZE rules instead of one
+// heap allocation each. A released rule gives its rhs back right away and its
+// slot goes on a free list, so the rules one rewriting phase drops are reused
+// by the next one. The blocks are only freed, all at once, with the arena.
+class RuleArena {
+  static const int BLOCK_SIZE = 512;
+  vector<ProductionRule*> blocks;
+  // slots of the last block constructed so far
+  int numUsedInLast;
+  vector<ProductionRule*> freeSlots;
+
+ public:
+  RuleArena();
+  ~RuleArena();
+  RuleArena(const RuleArena&) = delete;
+  RuleArena& operator=(const RuleArena&) = delete;
+  ProductionRule* create(Symbol* lhs, vector<Symbol*>&& rhs);
+  // pr must come from create and not be used afterwards
+  void release(ProductionRule* pr);
+};
+
+#endif
@@ -0,0 +1,209 @@
+#include "RuleTable.hpp"
+
+#include <algorithm>
+
+ProductionRule RuleTable::removedSlot(nullptr, {});
+
+size_t RuleTable::hashRule(const Symbol* lhs, const vector<Symbol*>& rhs) {
+  uint64_t hash = lhs->id;
+  for (const Symbol* sym : rhs) {
+    hash ^= sym->id + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+  }
+  // the slot comes from the low bits, so mix the high ones in
+  hash ^= hash >> 31;
+  hash *= 0xbf58476d1ce4e5b9ULL;
+  hash ^= hash >> 29;
+  return hash;
+}
+
+RuleTable::RuleTable() {
+  this->lastGroup = -1;
+  this->numRules = 0;
+  this->numRemovedSlots = 0;
+}
+
+int RuleTable::findSlot(const Symbol* lhs, const vector<Symbol*>& rhs) const {
+  if (this->slots.empty()) return -1;
+  size_t mask = this->slots.size() - 1;
+  for (size_t k = hashRule(lhs, rhs) & mask;; k = (k + 1) & mask) {
+    const ProductionRule* pr = this->slots[k];
+    if (pr == nullptr) return -1;
+    if (pr != &removedSlot && pr->lhs == lhs && pr->rhs == rhs) return k;
+  }
+}
+
+void RuleTable::insertSlot(ProductionRule* pr) {
+  if (2 * (this->numRules + this->numRemovedSlots + 1) >
+      (int)this->slots.size()) {
+    int numSlots = 64;
+    while (numSlots < 4 * (this->numRules + 1)) numSlots *= 2;
+    this->rehash(numSlots);
+  }
+  size_t mask = this->slots.size() - 1;
+  size_t k = hashRule(pr->lhs, pr->rhs) & mask;
+  while (this->slots[k] != nullptr && this->slots[k] != &removedSlot) {
+    k = (k + 1) & mask;
+  }
+  if (this->slots[k] == &removedSlot) this->numRemovedSlots--;
+  this->slots[k] = pr;
+}
+
+void RuleTable::eraseSlot(ProductionRule* pr) {
+  size_t mask = this->slots.size() - 1;
+  size_t k = hashRule(pr->lhs, pr->rhs) & mask;
+  while (this->slots[k] != pr) k = (k + 1) & mask;
+  this->slots[k] = &removedSlot;
+  this->numRemovedSlots++;
+}
+
+void RuleTable::rehash(int numSlots) {
+  vector<ProductionRule*> oldSlots(numSlots, nullptr);
+  oldSlots.swap(this->slots);
+  this->numRemovedSlots = 0;
+  size_t mask = numSlots - 1;
+  for (ProductionRule* pr : oldSlots) {
+    if (pr == nullptr || pr == &removedSlot) continue;
+    size_t k = hashRule(pr->lhs, pr->rhs) & mask;
+    while (this->slots[k] != nullptr) k = (k + 1) & mask;
+    this->slots[k] = pr;
+  }
+}
+
+void RuleTable::ensureGroup(int lhsId) {
+  if (lhsId >= (int)this->groupBegin.size()) {
+    this->groupBegin.resize(lhsId + 1, 0);
+    this->groupEnd.resize(lhsId + 1, 0);
+  }
+}
+
+void RuleTable::moveGroupToEnd(int lhsId) {
+  int newBegin = this->rules.size();
+  for (int k = this->groupBegin[lhsId]; k < this->groupEnd[lhsId]; ++k) {
+    ProductionRule* pr = this->rules[k];
+    this->rules[k] = nullptr;
+    this->rules.push_back(pr);
+  }
+  this->groupBegin[lhsId] = newBegin;
+  this->groupEnd[lhsId] = this->rules.size();
+  this->lastGroup = lhsId;
+}
+
+void RuleTable::dropHoles() {
+  // groups never contain holes, so a rule starts a new group exactly when its
+  // lhs differs from the one of the previous rule
+  fill(this->groupBegin.begin(), this->groupBegin.end(), 0);
+  fill(this->groupEnd.begin(), this->groupEnd.end(), 0);
+  int next = 0;
+  int prevLhs = -1;
+  for (int k = 0; k < (int)this->rules.size(); ++k) {
+    ProductionRule* pr = this->rules[k];
+    if (pr == nullptr) continue;
+    int lhsId = pr->lhs->id;
+    if (lhsId != prevLhs) {
+      this->groupBegin[lhsId] = next;
+      prevLhs = lhsId;
+    }
+    this->rules[next++] = pr;
+    this->groupEnd[lhsId] = next;
+  }
+  this->rules.resize(next);
+  this->lastGroup = prevLhs;
+}
+
+ProductionRule* RuleTable::find(Symbol* lhs,
+                                const vector<Symbol*>& rhs) const {
+  int slot = this->findSlot(lhs, rhs);
+  return (slot >= 0) ? this->slots[slot] : nullptr;
+}
+
+ProductionRule* RuleTable::add(Symbol* lhs, vector<Symbol*> rhs) {
+  int slot = this->findSlot(lhs, rhs);
+  if (slot >= 0) return this->slots[slot];
+
+  ProductionRule* pr = this->arena.create(lhs, move(rhs));
+  this->insertSlot(pr);
+  int lhsId = lhs->id;
+  this->ensureGroup(lhsId);
+  if (this->lastGroup != lhsId) {
+    // relocated groups leave holes behind; reclaim them once they dominate
+    if ((int)this->rules.size() > 2 * this->numRules + 1024) {
+      this->dropHoles();
+    }
+    if (this->lastGroup != lhsId) this->moveGroupToEnd(lhsId);
+  }
+  this->rules.push_back(pr);
+  this->groupEnd[lhsId]++;
+  this->numRules++;
+  return pr;
+}
+
+void RuleTable::remove(ProductionRule* pr) {
+  int lhsId = pr->lhs->id;
+  int last = this->groupEnd[lhsId] - 1;
+  for (int k = this->groupBegin[lhsId]; k <= last; ++k) {
+    if (this->rules[k] != pr) continue;
+    // fill the gap with the last rule of the group, so groups stay contiguous
+    this->rules[k] = this->rules[last];
+    this->rules[last] = nullptr;
+    this->groupEnd[lhsId]--;
+    if (this->lastGroup == lhsId) this->rules.pop_back();
+    this->eraseSlot(pr);
+    this->arena.release(pr);
+    this->numRules--;
+    return;
+  }
+}
+
+void RuleTable::removeAll(Symbol* lhs) {
+  int lhsId = lhs->id;
+  if (lhsId >= (int)this->groupBegin.size()) return;
+  for (int k = this->groupBegin[lhsId]; k < this->groupEnd[lhsId]; ++k) {
+    this->eraseSlot(this->rules[k]);
+    this->arena.release(this->rules[k]);
+    this->rules[k] = nullptr;
+    this->numRules--;
+  }
+  if (this->lastGroup == lhsId) this->rules.resize(this->groupBegin[lhsId]);
+  this->groupEnd[lhsId] = this->groupBegin[lhsId];
+}
+
+RuleRange RuleTable::rulesOf(const Symbol* lhs) const {
+  int lhsId = lhs->id;
+  if (lhsId >= (int)this->groupBegin.size()) return {nullptr, nullptr};
+  return {this->rules.data() + this->groupBegin[lhsId],
+          this->rules.data() + this->groupEnd[lhsId]};
+}
+
+int RuleTable::size() const { return this->numRules; }
+
+void RuleTable::compact(const vector<Symbol*>& lhsOrder) {
+  vector<ProductionRule*> compacted;
+  compacted.reserve(this->numRules);
+  vector<bool> isPlaced(this->groupBegin.size(), false);
+  auto placeGroup = [&](int lhsId) {
+    int newBegin = compacted.size();
+    for (int k = this->groupBegin[lhsId]; k < this->groupEnd[lhsId]; ++k) {
+      this->rules[k]->id = compacted.size();
+      compacted.push_back(this->rules[k]);
+    }
+    this->groupBegin[lhsId] = newBegin;
+    this->groupEnd[lhsId] = compacted.size();
+    isPlaced[lhsId] = true;
+    if (this->groupEnd[lhsId] > newBegin) this->lastGroup = lhsId;
+  };
+
+  this->lastGroup = -1;
+  for (const Symbol* lhs : lhsOrder) {
+    if (lhs->id < (int)isPlaced.size() && !isPlaced[lhs->id]) {
+      placeGroup(lhs->id);
+    }
+  }
+  for (int lhsId = 0; lhsId < (int)isPlaced.size(); ++lhsId) {
+    if (!isPlaced[lhsId]) placeGroup(lhsId);
+  }
+  this->rules.swap(compacted);
+}
+
+const vector<ProductionRule*>& RuleTable::allRules() const {
+  return this->rules;
+}
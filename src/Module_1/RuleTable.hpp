@@ -0,0 +1,82 @@
+#ifndef __RULE_TABLE_HPP__
+#define __RULE_TABLE_HPP__
+
+#include <vector>
+
+#include "../Common/structs.hpp"
+#include "RuleArena.hpp"
+
+using namespace std;
+
+// Read-only view of the (contiguous) production rules of one lhs
+struct RuleRange {
+  ProductionRule* const* first;
+  ProductionRule* const* last;
+  ProductionRule* const* begin() const { return this->first; }
+  ProductionRule* const* end() const { return this->last; }
+  int size() const { return this->last - this->first; }
+  bool empty() const { return this->first == this->last; }
+  ProductionRule* operator[](int i) const { return this->first[i]; }
+};
+
+// Production rules of a grammar in one flat vector, grouped by lhs.
+//
+// Rules are hash-consed: adding a rule equal to an existing one (same lhs and
+// rhs) returns the existing rule instead of storing it twice. A group grows in
+// place when it is the last one in the vector, otherwise it is moved to the
+// end first; the holes left behind are dropped by compact(), which also sorts
+// the groups and gives every rule its position as id. Nothing here depends on
+// pointer values, so the same sequence of calls always yields the same order.
+//
+// The rules live in a RuleArena: removing a rule frees its rhs and recycles
+// its slot, and all of them are freed together with the table.
+//
+// A RuleRange is invalidated by add, remove and compact.
+class RuleTable {
+  RuleArena arena;
+  vector<ProductionRule*> rules;
+  // rules of the lhs with id i: rules[groupBegin[i], groupEnd[i])
+  vector<int> groupBegin;
+  vector<int> groupEnd;
+  // lhs id of the group at the end of rules (-1 -> none)
+  int lastGroup;
+  int numRules;
+  // every rule by (lhs, rhs): open addressing with linear probing, at most
+  // half full (nullptr -> empty slot, &removedSlot -> rule removed)
+  vector<ProductionRule*> slots;
+  int numRemovedSlots;
+  static ProductionRule removedSlot;
+
+  static size_t hashRule(const Symbol* lhs, const vector<Symbol*>& rhs);
+  // slot of the rule lhs -> rhs, -1 if there is none
+  int findSlot(const Symbol* lhs, const vector<Symbol*>& rhs) const;
+  void insertSlot(ProductionRule* pr);
+  void eraseSlot(ProductionRule* pr);
+  void rehash(int numSlots);
+  void ensureGroup(int lhsId);
+  // moves the rules of lhsId to the end of rules, so that the group can grow
+  void moveGroupToEnd(int lhsId);
+  // drops the holes, keeping the current order of the groups
+  void dropHoles();
+
+ public:
+  RuleTable();
+  // returns the rule lhs -> rhs, which is created (from rhs, moved in)
+  // unless it already exists
+  ProductionRule* add(Symbol* lhs, vector<Symbol*> rhs);
+  // the rule lhs -> rhs, nullptr if there is none
+  ProductionRule* find(Symbol* lhs, const vector<Symbol*>& rhs) const;
+  // removes the rule and recycles it
+  void remove(ProductionRule* pr);
+  // removes and deletes all the rules of lhs
+  void removeAll(Symbol* lhs);
+  RuleRange rulesOf(const Symbol* lhs) const;
+  int size() const;
+  // places the groups next to each other in the order of lhsOrder (groups of
+  // other symbols follow in id order) and sets each rule's id to its index
+  void compact(const vector<Symbol*>& lhsOrder);
+  // all the rules; grouped in lhsOrder and indexed by id right after compact
+  const vector<ProductionRule*>& allRules() const;
+};
+
+#endif
@@ -0,0 +1,109 @@
+#ifndef __SYMBOL_SET_HPP__
+#define __SYMBOL_SET_HPP__
+
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+// Set of symbols, stored as a bitset over symbol ids. Unions and
+// intersections work a machine word at a time, and members are always visited
+// in ascending id order (which keeps everything printed from it stable).
+class SymbolSet {
+  vector<uint64_t> words;
+
+ public:
+  bool contains(int id) const {
+    int word = id >> 6;
+    return word < (int)this->words.size() &&
+           ((this->words[word] >> (id & 63)) & 1);
+  }
+
+  // returns true if id was not in the set yet
+  bool insert(int id) {
+    int word = id >> 6;
+    if (word >= (int)this->words.size()) this->words.resize(word + 1, 0);
+    uint64_t bit = uint64_t(1) << (id & 63);
+    if (this->words[word] & bit) return false;
+    this->words[word] |= bit;
+    return true;
+  }
+
+  // adds all the members of other except the one with id exceptId (pass -1 to
+  // add all of them), returns true if the set grew
+  bool unionWith(const SymbolSet& other, int exceptId = -1) {
+    if (other.words.size() > this->words.size()) {
+      this->words.resize(other.words.size(), 0);
+    }
+    uint64_t grew = 0;
+    for (int i = 0; i < (int)other.words.size(); ++i) {
+      uint64_t add = other.words[i];
+      if (exceptId >= 0 && (exceptId >> 6) == i) {
+        add &= ~(uint64_t(1) << (exceptId & 63));
+      }
+      grew |= add & ~this->words[i];
+      this->words[i] |= add;
+    }
+    return grew != 0;
+  }
+
+  // adds the members common to a and b
+  void unionWithCommon(const SymbolSet& a, const SymbolSet& b) {
+    int numWords = min(a.words.size(), b.words.size());
+    if (numWords > (int)this->words.size()) this->words.resize(numWords, 0);
+    for (int i = 0; i < numWords; ++i) {
+      this->words[i] |= a.words[i] & b.words[i];
+    }
+  }
+
+  // removes the members of other
+  void subtract(const SymbolSet& other) {
+    int numWords = min(this->words.size(), other.words.size());
+    for (int i = 0; i < numWords; ++i) this->words[i] &= ~other.words[i];
+  }
+
+  bool intersects(const SymbolSet& other) const {
+    int numWords = min(this->words.size(), other.words.size());
+    for (int i = 0; i < numWords; ++i) {
+      if (this->words[i] & other.words[i]) return true;
+    }
+    return false;
+  }
+
+  bool empty() const {
+    for (uint64_t word : this->words) {
+      if (word) return false;
+    }
+    return true;
+  }
+
+  int size() const {
+    int count = 0;
+    for (uint64_t word : this->words) count += __builtin_popcountll(word);
+    return count;
+  }
+
+  // calls fn(id) for every member, in ascending id order
+  template <typename Fn>
+  void forEach(Fn fn) const {
+    for (int i = 0; i < (int)this->words.size(); ++i) {
+      uint64_t word = this->words[i];
+      while (word) {
+        fn((i << 6) + __builtin_ctzll(word));
+        word &= word - 1;
+      }
+    }
+  }
+
+  bool operator==(const SymbolSet& other) const {
+    int numWords = max(this->words.size(), other.words.size());
+    for (int i = 0; i < numWords; ++i) {
+      uint64_t a = (i < (int)this->words.size()) ? this->words[i] : 0;
+      uint64_t b = (i < (int)other.words.size()) ? other.words[i] : 0;
+      if (a != b) return false;
+    }
+    return true;
+  }
+};
+
+#endif
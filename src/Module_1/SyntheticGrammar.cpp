@@ -0,0 +1,66 @@
+#include "SyntheticGrammar.hpp"
+
+#include <random>
+#include <sstream>
+#include <vector>
+
+string generateSyntheticGrammar(const SyntheticGrammarOptions& options) {
+  int numNonTers = max(1, options.numNonTers);
+  int numTerminals = max(3, options.numTerminals);
+  mt19937 random(options.seed);
+  auto chance = [&random](double fraction) {
+    return uniform_real_distribution<double>(0, 1)(random) < fraction;
+  };
+  auto nonTer = [](int i) { return "N" + to_string(i); };
+  auto terminal = [&](int i) { return "t" + to_string(i % numTerminals); };
+  auto anyTerminal = [&]() {
+    return terminal(uniform_int_distribution<int>(0, numTerminals - 1)(random));
+  };
+
+  // Leading non-terminals only point to the next non-terminal, except for
+  // the last edge of a ring and for left-recursive rules, so these are the
+  // only cycles of the left-corner graph
+  vector<vector<string>> rules(numNonTers);
+  for (int i = 0; i < numNonTers; ++i) {
+    // plain rule keeping the rest reachable (and everything productive)
+    string plain = anyTerminal();
+    if (i + 1 < numNonTers) plain += " " + nonTer(i + 1);
+    rules[i].push_back(plain);
+    if (chance(options.leftRecursion)) {
+      rules[i].push_back(nonTer(i) + " " + anyTerminal() + " " + anyTerminal());
+    }
+    if (chance(options.commonPrefixes)) {
+      int prefix = uniform_int_distribution<int>(0, numTerminals - 1)(random);
+      string rest = (i + 1 < numNonTers) ? " " + nonTer(i + 1) : "";
+      rules[i].push_back(terminal(prefix) + " " + terminal(prefix + 1) + rest);
+      rules[i].push_back(terminal(prefix) + " " + terminal(prefix + 2));
+    }
+    if (i + 1 < numNonTers && chance(options.nullableChains)) {
+      rules[i].push_back(nonTer(i + 1) + " " + anyTerminal());
+      rules[i + 1].push_back("ε");
+    }
+  }
+  for (int i = 0; i + 2 < numNonTers; i += 3) {
+    if (!chance(options.indirectRecursion)) continue;
+    for (int k = 0; k < 3; ++k) {
+      int next = i + (k + 1) % 3;
+      rules[i + k].push_back(nonTer(next) + " " + anyTerminal());
+    }
+  }
+
+  ostringstream grammar;
+  grammar << numNonTers << "\n";
+  for (int i = 0; i < numNonTers; ++i) grammar << nonTer(i) << " ";
+  grammar << "\n" << numTerminals << "\n";
+  for (int i = 0; i < numTerminals; ++i) grammar << terminal(i) << " ";
+  grammar << "\n" << numNonTers << "\n";
+  for (int i = 0; i < numNonTers; ++i) {
+    grammar << nonTer(i) << " -> [ ";
+    for (int r = 0; r < (int)rules[i].size(); ++r) {
+      grammar << (r == 0 ? "" : " | ") << rules[i][r];
+    }
+    grammar << " ]\n";
+  }
+  grammar << nonTer(0) << "\n";
+  return grammar.str();
+}
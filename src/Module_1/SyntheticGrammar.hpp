@@ -0,0 +1,38 @@
+#ifndef __SYNTHETIC_GRAMMAR_HPP__
+#define __SYNTHETIC_GRAMMAR_HPP__
+
+#include <string>
+
+using namespace std;
+
+// Shape of a generated grammar. The fractions say how many non-terminals get
+// each kind of rule; the rest only get plain rules.
+struct SyntheticGrammarOptions {
+  int numNonTers;
+  int numTerminals;
+  // A -> A t ...
+  double leftRecursion;
+  // A -> t u B | t v (two rules sharing a prefix)
+  double commonPrefixes;
+  // A -> B t with B -> ε, chained over consecutive non-terminals
+  double nullableChains;
+  // A -> B t, B -> C t, C -> A t (rings of three non-terminals)
+  double indirectRecursion;
+  unsigned seed;
+  SyntheticGrammarOptions() {
+    this->numNonTers = 100;
+    this->numTerminals = 20;
+    this->leftRecursion = 0.2;
+    this->commonPrefixes = 0.2;
+    this->nullableChains = 0.2;
+    this->indirectRecursion = 0.2;
+    this->seed = 1;
+  }
+};
+
+// Grammar in the format read by LL1::readCFGFile. Every non-terminal is
+// reachable from the start symbol and derives some terminal string, and
+// left recursion only shows up where the options ask for it.
+string generateSyntheticGrammar(const SyntheticGrammarOptions& options);
+
+#endif
@@ -0,0 +1,80 @@
+#include "ThreadPool.hpp"
+
+#include <atomic>
+
+ThreadPool::ThreadPool(int numThreads) {
+  this->numPendingTasks = 0;
+  this->isStopping = false;
+  if (numThreads < 1) numThreads = 1;
+  for (int i = 0; i < numThreads; ++i) {
+    this->workers.emplace_back(&ThreadPool::workerLoop, this);
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  {
+    unique_lock<mutex> lock(this->tasksMutex);
+    this->isStopping = true;
+  }
+  this->taskAvailable.notify_all();
+  for (thread& worker : this->workers) {
+    worker.join();
+  }
+}
+
+int ThreadPool::size() const { return this->workers.size(); }
+
+void ThreadPool::workerLoop() {
+  while (true) {
+    function<void()> task;
+    {
+      unique_lock<mutex> lock(this->tasksMutex);
+      this->taskAvailable.wait(
+          lock, [this] { return this->isStopping || !this->tasks.empty(); });
+      if (this->tasks.empty()) return;
+      task = move(this->tasks.front());
+      this->tasks.pop();
+    }
+    task();
+    {
+      unique_lock<mutex> lock(this->tasksMutex);
+      if (--this->numPendingTasks == 0) this->allTasksDone.notify_all();
+    }
+  }
+}
+
+void ThreadPool::submit(const function<void()>& task) {
+  {
+    unique_lock<mutex> lock(this->tasksMutex);
+    this->tasks.push(task);
+    ++this->numPendingTasks;
+  }
+  this->taskAvailable.notify_one();
+}
+
+void ThreadPool::wait() {
+  unique_lock<mutex> lock(this->tasksMutex);
+  this->allTasksDone.wait(lock, [this] { return this->numPendingTasks == 0; });
+}
+
+void ThreadPool::parallelFor(int n, const function<void(int)>& fn) {
+  // every worker pulls the next unclaimed index, so uneven items balance out
+  atomic<int> nextIndex(0);
+  exception_ptr firstError = nullptr;
+  mutex errorMutex;
+  int numTasks = min(n, this->size());
+  for (int t = 0; t < numTasks; ++t) {
+    this->submit([&] {
+      for (int i = nextIndex++; i < n; i = nextIndex++) {
+        try {
+          fn(i);
+        } catch (...) {
+          unique_lock<mutex> lock(errorMutex);
+          if (!firstError) firstError = current_exception();
+        }
+      }
+    });
+  }
+  this->wait();
+  if (firstError) rethrow_exception(firstError);
+}
@@ -0,0 +1,39 @@
+#ifndef __THREAD_POOL_HPP__
+#define __THREAD_POOL_HPP__
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Fixed set of worker threads executing submitted tasks in FIFO order
+class ThreadPool {
+  vector<thread> workers;
+  queue<function<void()>> tasks;
+  mutex tasksMutex;
+  condition_variable taskAvailable;
+  condition_variable allTasksDone;
+  // number of tasks submitted but not finished yet
+  int numPendingTasks;
+  bool isStopping;
+
+  void workerLoop();
+
+ public:
+  ThreadPool(int numThreads);
+  ~ThreadPool();
+  int size() const;
+  void submit(const function<void()>& task);
+  // blocks till every submitted task has finished
+  void wait();
+  // calls fn(0), fn(1), ..., fn(n - 1) on the workers and blocks till all of
+  // them return; the first exception thrown by fn is rethrown to the caller
+  void parallelFor(int n, const function<void(int)>& fn);
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include <unistd.h>
+
+#include "LL1.hpp"
+#include "SyntheticGrammar.hpp"
+
+// Scaling benchmark of the grammar compiler: compiles synthetic grammars of
+// growing size (adaptive, so that conflicts don't stop the pipeline) and fits
+// time = c * n^b to every phase, n being the number of non-terminals.
+
+static void printUsage(const char* prog) {
+  cout << "Usage: " << prog << " [-n N,N,...] [-t terminals] [-r repeats]"
+       << " [-L f] [-P f] [-E f] [-I f] [-s seed] [-x max-exponent]\n"
+       << "  -n    numbers of non-terminals to sweep"
+       << " (default: 250,500,1000,2000,4000)\n"
+       << "  -t    number of terminals (default: 50)\n"
+       << "  -r    compile each grammar this many times, keep the fastest"
+       << " (default: 3)\n"
+       << "  -L -P -E -I  fractions of non-terminals with left recursion,"
+       << " common\n"
+       << "        prefixes, nullable chains and indirect recursion"
+       << " (default: 0.2)\n"
+       << "  -x    exit with failure if a phase grows faster than n^x\n";
+}
+
+// exponent b of the least squares fit of log(ms) = log(c) + b * log(n), over
+// the sizes taking long enough to be measured (NAN if there are too few)
+static double fitExponent(const vector<int>& sizes, const vector<double>& ms) {
+  const double minMilliseconds = 0.05;
+  vector<pair<double, double>> points;
+  for (int i = 0; i < (int)sizes.size(); ++i) {
+    if (!isfinite(ms[i]) || ms[i] < minMilliseconds) continue;
+    points.push_back({log(sizes[i]), log(ms[i])});
+  }
+  if (points.size() < 2) return NAN;
+  double meanX = 0, meanY = 0;
+  for (const auto& [x, y] : points) {
+    meanX += x / points.size();
+    meanY += y / points.size();
+  }
+  double covariance = 0, variance = 0;
+  for (const auto& [x, y] : points) {
+    covariance += (x - meanX) * (y - meanY);
+    variance += (x - meanX) * (x - meanX);
+  }
+  return covariance / variance;
+}
+
+int main(int argc, char* argv[]) {
+  vector<int> sizes{250, 500, 1000, 2000, 4000};
+  SyntheticGrammarOptions grammarOptions;
+  int numTerminals = 50, numRepeats = 3;
+  double maxExponent = 0;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (i + 1 >= argc) {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+    string value = argv[++i];
+    if (arg == "-n") {
+      sizes.clear();
+      stringstream list(value);
+      for (string size; getline(list, size, ',');) sizes.push_back(stoi(size));
+    } else if (arg == "-t") {
+      numTerminals = stoi(value);
+    } else if (arg == "-r") {
+      numRepeats = max(1, stoi(value));
+    } else if (arg == "-L") {
+      grammarOptions.leftRecursion = stod(value);
+    } else if (arg == "-P") {
+      grammarOptions.commonPrefixes = stod(value);
+    } else if (arg == "-E") {
+      grammarOptions.nullableChains = stod(value);
+    } else if (arg == "-I") {
+      grammarOptions.indirectRecursion = stod(value);
+    } else if (arg == "-s") {
+      grammarOptions.seed = stoul(value);
+    } else if (arg == "-x") {
+      maxExponent = stod(value);
+    } else {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  string grammarPath = (filesystem::temp_directory_path() /
+                        ("ll1-benchmark-" + to_string(getpid()) + ".txt"))
+                           .string();
+  // phases in the order they first ran, ms[phase][size index]
+  vector<string> phases;
+  map<string, vector<double>> ms;
+  vector<double> totalMs(sizes.size(), 0);
+  vector<int> numRules(sizes.size(), 0);
+  for (int s = 0; s < (int)sizes.size(); ++s) {
+    grammarOptions.numNonTers = sizes[s];
+    grammarOptions.numTerminals = numTerminals;
+    ofstream(grammarPath) << generateSyntheticGrammar(grammarOptions);
+
+    for (int repeat = 0; repeat < numRepeats; ++repeat) {
+      ostringstream log;
+      LL1Options options;
+      options.grammarPath = grammarPath;
+      options.verbose = false;
+      options.adaptive = true;
+      options.collectStats = true;
+      options.log = &log;
+      options.exitOnError = false;
+      try {
+        LL1 cfg(options);
+        cfg.compile();
+        numRules[s] = cfg.numProductionRules();
+        double total = 0;
+        for (const PhaseStats& stats : cfg.getPhaseStats()) {
+          vector<double>& phaseMs = ms[stats.name];
+          if (phaseMs.empty()) {
+            phases.push_back(stats.name);
+            phaseMs.assign(sizes.size(), INFINITY);
+          }
+          phaseMs[s] = min(phaseMs[s], stats.milliseconds);
+          total += stats.milliseconds;
+        }
+        totalMs[s] = (repeat == 0) ? total : min(totalMs[s], total);
+      } catch (string message) {
+        cout << "n = " << sizes[s] << ": " << log.str();
+        filesystem::remove(grammarPath);
+        return EXIT_FAILURE;
+      }
+    }
+  }
+  filesystem::remove(grammarPath);
+  phases.push_back("total");
+  ms["total"] = totalMs;
+
+  cout << "Time per phase (ms, fastest of " << numRepeats << " runs)\n";
+  cout << left << setw(24) << "n" << right;
+  for (int size : sizes) cout << setw(10) << size;
+  cout << setw(10) << "O(n^b)" << "\n";
+  cout << left << setw(24) << "rules after rewriting" << right;
+  for (int rules : numRules) cout << setw(10) << rules;
+  cout << "\n";
+  bool tooSlow = false;
+  cout << fixed;
+  for (const string& phase : phases) {
+    cout << left << setw(24) << phase << right << setprecision(2);
+    for (double phaseMs : ms[phase]) {
+      if (isinf(phaseMs)) {
+        cout << setw(10) << "-";
+      } else {
+        cout << setw(10) << phaseMs;
+      }
+    }
+    double exponent = fitExponent(sizes, ms[phase]);
+    if (isnan(exponent)) {
+      cout << setw(10) << "-";
+    } else {
+      cout << setw(10) << setprecision(2) << exponent;
+    }
+    if (maxExponent > 0 && exponent > maxExponent) {
+      cout << "  above " << maxExponent;
+      tooSlow = true;
+    }
+    cout << "\n";
+  }
+  return tooSlow ? EXIT_FAILURE : 0;
+}
@@ -1,15 +1,206 @@
+#include "../Common/LL1Parser.hpp"
+#include "ArtifactCache.hpp"
+#include "GrammarBatch.hpp"
 #include "LL1.hpp"
 #include "lexFns.hpp"
 
-int main() {
-  LL1 cfg;
-  string dirPath;
-  cout << "Enter a (relative/absolute) path of a directory where the grammar's "
-          "files should be saved:\n";
-  cin >> dirPath;
+static void printUsage(const char* prog) {
+  cout << "Usage: " << prog << " [-j N] [-x] [-k K] [-a] [-m]"
+       << " [-g grammar-file [-o output-dir]"
+       << " [-F] [-G] [-T] [-v] [-c cache-dir] [-f] [-i] [-s stats-file]"
+       << " [-p tokens-file] [-P plugin]]"
+       << " [-b grammar-dir...]\n"
+       << "  -j N  run the grammar compilation phases on N threads\n"
+       << "  -x    expand leading non-terminals while left factoring\n"
+       << "  -k K  look at up to K (1-3) input symbols where 1 is not enough\n"
+       << "  -a    leave cells still claimed by several rules to the parser\n"
+       << "  -m    drop useless non-terminals, inline unit/single-use rules\n"
+       << "  -g    read the grammar from a file instead of prompting for it\n"
+       << "  -o    directory where the grammar's files are saved (default: .)\n"
+       << "  -F    write " << FIRST_FOLLOW_FILE_NAME << "\n"
+       << "  -G    write " << LL1_GRAMMAR_FILE_NAME << "\n"
+       << "  -T    write " << PARSE_TABLE_FILE_NAME << "\n"
+       << "        (-g without any of -F, -G and -T writes all three)\n"
+       << "  -v    print the CFG, first/follow sets and the parsing table\n"
+       << "  -c    shared cache of generated files (default: $LL1_CACHE_DIR)\n"
+       << "  -f    regenerate the files even if they are up to date\n"
+       << "  -i    compile incrementally, from the state of the last -i run\n"
+       << "        (kept in the output directory as "
+       << COMPILATION_STATE_FILE_NAME << ")\n"
+       << "  -s    write the time, memory and iterations of every phase as\n"
+       << "        JSON when the files are generated (with -b: into each\n"
+       << "        directory)\n"
+       << "  -p    parse the tokens of a file (separated by white space) with\n"
+       << "        the grammar, handed to the parser in memory; no files are\n"
+       << "        written unless -F, -G or -T is given\n"
+       << "  -P    build the parser of an LL(1) grammar into the shared\n"
+       << "        object plugin, from its source in plugin.cpp; no files are\n"
+       << "        written unless -F, -G or -T is given\n"
+       << "  -b    compile the " << GRAMMAR_FILE_NAME
+       << " of each directory into it, N at a\n"
+       << "        time (with -j N), and print a summary (must come last)\n";
+}
+
+int main(int argc, char* argv[]) {
+  // Without -g the grammar and the output directory are read interactively
+  // and everything is printed along the way. With -g the compiler runs in
+  // batch mode: no prompts, no dumps unless -v is given.
+  LL1Options options;
+  string dirPath = "";
+  bool writeFirstFollow = false, writeGrammar = false, writeTable = false;
+  bool verbose = false, force = false, incremental = false;
+  const char* cacheDirEnv = getenv("LL1_CACHE_DIR");
+  string cacheDir = (cacheDirEnv != nullptr) ? cacheDirEnv : "";
+  vector<string> grammarDirs;
+  string statsPath = "";
+  string tokensPath = "";
+  string pluginPath = "";
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "-j" && i + 1 < argc) {
+      options.numThreads = stoi(argv[++i]);
+    } else if (arg == "-x") {
+      options.expandLeadingNonTers = true;
+    } else if (arg == "-k" && i + 1 < argc) {
+      options.lookahead = atoi(argv[++i]);
+      if (options.lookahead < 1 || options.lookahead > 3) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+    } else if (arg == "-m") {
+      options.minimize = true;
+    } else if (arg == "-a") {
+      options.adaptive = true;
+    } else if (arg == "-g" && i + 1 < argc) {
+      options.grammarPath = argv[++i];
+    } else if (arg == "-o" && i + 1 < argc) {
+      dirPath = argv[++i];
+    } else if (arg == "-F") {
+      writeFirstFollow = true;
+    } else if (arg == "-G") {
+      writeGrammar = true;
+    } else if (arg == "-T") {
+      writeTable = true;
+    } else if (arg == "-v") {
+      verbose = true;
+    } else if (arg == "-c" && i + 1 < argc) {
+      cacheDir = argv[++i];
+    } else if (arg == "-f") {
+      force = true;
+    } else if (arg == "-i") {
+      incremental = true;
+    } else if (arg == "-s" && i + 1 < argc) {
+      statsPath = argv[++i];
+      options.collectStats = true;
+    } else if (arg == "-p" && i + 1 < argc) {
+      tokensPath = argv[++i];
+    } else if (arg == "-P" && i + 1 < argc) {
+      pluginPath = argv[++i];
+    } else if (arg == "-b" && i + 1 < argc) {
+      grammarDirs.assign(argv + i + 1, argv + argc);
+      break;
+    } else {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if (!grammarDirs.empty()) {
+    // every grammar is compiled on one thread of the batch, -j is the number
+    // of grammars compiled at a time
+    options.verbose = verbose;
+    GrammarBatch batch(grammarDirs, options, force, statsPath);
+    batch.run(options.numThreads);
+    batch.printSummary(cout);
+    return batch.succeeded() ? 0 : EXIT_FAILURE;
+  }
+
+  bool batchMode = (options.grammarPath != "");
+  if (batchMode) {
+    options.verbose = verbose;
+    bool writeNone = !writeFirstFollow && !writeGrammar && !writeTable;
+    if (writeNone && tokensPath == "" && pluginPath == "") {
+      writeFirstFollow = writeGrammar = writeTable = true;
+    }
+  } else {
+    writeFirstFollow = writeGrammar = writeTable = true;
+  }
+
+  LL1 cfg(options);
+  if (!batchMode) {
+    cfg.compile();
+    cout << "Enter a (relative/absolute) path of a directory where the "
+            "grammar's files should be saved:\n";
+    cin >> dirPath;
+    cfg.setDirPath(dirPath);
+    cfg.createFirstFollowFile();
+    cfg.createLL1GrammarFile();
+    cfg.createParseTableFile();
+    return 0;
+  }
+
+  if (tokensPath != "" || pluginPath != "") {
+    // no generated files are read back: the parser and the plugin get the
+    // tables as compiled
+    vector<string> tokens;
+    if (tokensPath != "") {
+      ifstream tokensFile(tokensPath);
+      if (!tokensFile) {
+        cout << "Error: can't read " << tokensPath << "\n";
+        return EXIT_FAILURE;
+      }
+      for (string token; tokensFile >> token;) tokens.push_back(token);
+      tokens.push_back(DOLLAR_SYMBOL);
+    }
+    cfg.compile();
+    cfg.setDirPath(dirPath);
+    if (writeFirstFollow) cfg.createFirstFollowFile();
+    if (writeGrammar) cfg.createLL1GrammarFile();
+    if (writeTable) cfg.createParseTableFile();
+    if (statsPath != "") cfg.createStatsFile(statsPath);
+    if (pluginPath != "") cfg.createPluginFile(pluginPath);
+    if (tokensPath == "") return 0;
+    LL1Parser parser(cfg.getParserTables());
+    bool isValid = parser.predictiveParsing(tokens);
+    cout << "Verdict: " << (isValid ? "Accepted" : "Rejected") << "\n";
+    return isValid ? 0 : EXIT_FAILURE;
+  }
+
+  // batch mode: the grammar's hash decides whether there is anything to do
+  vector<string> fileNames;
+  if (writeFirstFollow) fileNames.push_back(FIRST_FOLLOW_FILE_NAME);
+  if (writeGrammar) fileNames.push_back(LL1_GRAMMAR_FILE_NAME);
+  if (writeTable) fileNames.push_back(PARSE_TABLE_FILE_NAME);
+
+  ArtifactCache cache(cacheDir);
+  const string& grammarHash = cfg.getGrammarHash();
+  string outDir = (dirPath != "") ? dirPath : ".";
+  bool upToDate = !force;
+  for (int i = 0; upToDate && i < (int)fileNames.size(); ++i) {
+    upToDate = ArtifactCache::isUpToDate(outDir + "/" + fileNames[i],
+                                         grammarHash) ||
+               cache.restore(grammarHash, fileNames[i], outDir);
+  }
+  if (upToDate) {
+    if (verbose) {
+      cout << "Generated files are up to date (" << grammarHash << ")\n";
+    }
+    return 0;
+  }
+
+  string statePath = outDir + "/" + COMPILATION_STATE_FILE_NAME;
+  cfg.compile(incremental ? statePath : "");
   cfg.setDirPath(dirPath);
-  cfg.createFirstFollowFile();
-  cfg.createLL1GrammarFile();
-  cfg.createParseTableFile();
+  if (writeFirstFollow) cfg.createFirstFollowFile();
+  if (writeGrammar) cfg.createLL1GrammarFile();
+  if (writeTable) cfg.createParseTableFile();
+  if (statsPath != "") cfg.createStatsFile(statsPath);
+  // the state file only holds an LL(1) table (see LL1::compile)
+  if (incremental && options.lookahead == 1 && !options.adaptive) {
+    cfg.createStateFile(statePath);
+  }
+  for (const string& fileName : fileNames) {
+    cache.store(grammarHash, fileName, outDir);
+  }
   return 0;
 }
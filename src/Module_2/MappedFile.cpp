@@ -0,0 +1,57 @@
+#include "MappedFile.hpp"
+
+#include <algorithm>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+MappedFile::MappedFile(const string& path) {
+  this->data = nullptr;
+  this->size = 0;
+  this->mappedSize = 0;
+  this->releasedSize = 0;
+
+  int fd = open(path.c_str(), O_RDONLY);
+  if (fd < 0) throw string("cannot open " + path);
+  struct stat fileStat;
+  if (fstat(fd, &fileStat) < 0) {
+    close(fd);
+    throw string("cannot read " + path);
+  }
+  this->size = fileStat.st_size;
+  // zeroed anonymous pages with room for the sentinels, the file mapped over
+  // their beginning (the rest of the file's last page reads as zeros too)
+  size_t pageSize = sysconf(_SC_PAGESIZE);
+  this->mappedSize = (this->size + 2 + pageSize - 1) / pageSize * pageSize;
+  void* mapping = mmap(nullptr, this->mappedSize, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (mapping == MAP_FAILED) {
+    close(fd);
+    throw string("cannot map " + path);
+  }
+  if (this->size > 0) {
+    if (mmap(mapping, this->size, PROT_READ | PROT_WRITE,
+             MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED) {
+      munmap(mapping, this->mappedSize);
+      close(fd);
+      throw string("cannot map " + path);
+    }
+    // scanners only move forward
+    madvise(mapping, this->size, MADV_SEQUENTIAL);
+  }
+  close(fd);
+  this->data = (char*)mapping;
+}
+
+MappedFile::~MappedFile() { munmap(this->data, this->mappedSize); }
+
+void MappedFile::release(size_t offset) {
+  size_t pageSize = sysconf(_SC_PAGESIZE);
+  size_t end = min(offset, this->size) / pageSize * pageSize;
+  if (end <= this->releasedSize) return;
+  madvise(this->data + this->releasedSize, end - this->releasedSize,
+          MADV_DONTNEED);
+  this->releasedSize = end;
+}
@@ -0,0 +1,42 @@
+#ifndef __MODULE_2_MAPPED_FILE_HPP__
+#define __MODULE_2_MAPPED_FILE_HPP__
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+using namespace std;
+
+// A file mapped into memory to be scanned in place, followed by two NUL
+// sentinels (data()[size()] and data()[size() + 1]), as flex's
+// yy_scan_buffer expects. The mapping is private and writable: a scanner
+// may write into it (flex NUL-terminates yytext), which the file never sees.
+class MappedFile {
+  char* data;
+  size_t size;
+  // bytes reserved for the file and its sentinels (whole pages)
+  size_t mappedSize;
+  // bytes at the beginning whose pages were released
+  size_t releasedSize;
+
+ public:
+  // throws a message (string) if the file can't be mapped
+  MappedFile(const string& path);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  char* getData() { return this->data; }
+  const char* getData() const { return this->data; }
+  size_t getSize() const { return this->size; }
+  string_view view(size_t offset, size_t length) const {
+    return string_view(this->data + offset, length);
+  }
+  size_t getReleasedSize() const { return this->releasedSize; }
+  // drops the pages wholly before offset, private copies included, for a
+  // scanner that is past them: the memory a scan keeps stays bounded (reading
+  // them again maps the file's bytes back in)
+  void release(size_t offset);
+};
+
+#endif
@@ -0,0 +1,62 @@
+#include "Scanner.hpp"
+
+#include <climits>
+
+// bytes scanned in place between releases of the pages behind the scanner
+static const size_t RELEASE_STEP = 1 << 20;
+
+void Scanner::init() {
+  this->file = nullptr;
+  this->state.lineNumber = 1;
+  this->state.tokenType = "";
+  this->state.tokenOffset = 0;
+  this->state.tokenLength = 0;
+  if (yylex_init_extra(&this->state, &this->scanner) != 0) {
+    throw string("Couldn't allocate a scanner");
+  }
+}
+
+Scanner::Scanner(FILE* input) {
+  this->init();
+  yyset_in(input, this->scanner);
+}
+
+Scanner::Scanner(const string& text) {
+  this->init();
+  yy_scan_bytes(text.data(), (int)text.size(), this->scanner);
+}
+
+Scanner::Scanner(MappedFile& file) {
+  this->init();
+  // flex keeps buffer sizes in ints
+  if (file.getSize() > INT_MAX - 2) {
+    yylex_destroy(this->scanner);
+    throw string("The input is too large to be scanned in place");
+  }
+  // the size includes the two NUL sentinels
+  yy_scan_buffer(file.getData(), file.getSize() + 2, this->scanner);
+  this->file = &file;
+}
+
+Scanner::~Scanner() { yylex_destroy(this->scanner); }
+
+int Scanner::next() {
+  // flex NUL-terminates yytext in place, so every page scanned becomes a
+  // private copy: give back those of the tokens already returned
+  if (this->file != nullptr &&
+      this->state.tokenOffset >=
+          this->file->getReleasedSize() + RELEASE_STEP) {
+    this->file->release(this->state.tokenOffset);
+  }
+  return yylex(this->scanner);
+}
+
+const char* Scanner::getText() const { return yyget_text(this->scanner); }
+
+const char* Scanner::getTokenType() const { return this->state.tokenType; }
+
+int Scanner::getLineNumber() const { return this->state.lineNumber; }
+
+size_t Scanner::getOffset() const { return this->state.tokenOffset; }
+
+size_t Scanner::getLength() const { return this->state.tokenLength; }
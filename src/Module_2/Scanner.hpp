@@ -0,0 +1,48 @@
+#ifndef __MODULE_2_SCANNER_HPP__
+#define __MODULE_2_SCANNER_HPP__
+
+#include <cstdio>
+#include <string>
+
+#include "MappedFile.hpp"
+#include "lexFns.hpp"
+
+using namespace std;
+
+// A scanner of lex.l's tokens with state of its own (buffers and line
+// number), so that several inputs can be lexed at once, one Scanner per
+// thread. Not copyable.
+class Scanner {
+  ScannerState state;
+  yyscan_t scanner;
+  // the input when scanning a file in place
+  MappedFile* file;
+
+  void init();
+
+ public:
+  // reads the stream (not closed by the scanner) up to its end
+  explicit Scanner(FILE* input);
+  // scans a copy of the text
+  explicit Scanner(const string& text);
+  // scans the mapped file in place, without copying it into flex's buffer;
+  // the file must outlive the scanner
+  explicit Scanner(MappedFile& file);
+  ~Scanner();
+  Scanner(const Scanner&) = delete;
+  Scanner& operator=(const Scanner&) = delete;
+
+  // the next token's code (see lexFns.hpp), ERROR_TOKEN for a character that
+  // starts no token, 0 at the end of the input
+  int next();
+  // lexeme and grammar terminal of the last token, valid until the next call
+  const char* getText() const;
+  const char* getTokenType() const;
+  int getLineNumber() const;
+  // span of the last token's lexeme: offset in bytes from the beginning of
+  // the input (e.g. into a MappedFile) and length
+  size_t getOffset() const;
+  size_t getLength() const;
+};
+
+#endif
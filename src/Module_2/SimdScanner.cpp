@@ -0,0 +1,325 @@
+#include "SimdScanner.hpp"
+
+#include <algorithm>
+
+#ifdef __x86_64__
+#include <immintrin.h>
+#endif
+
+static const size_t BLOCK_SIZE = 64;
+
+static const string_view KEYWORDS[] = {
+    "and", "else", "end", "if", "int", "do", "float",
+    "not", "or", "print", "prog", "scan", "then", "while"};
+
+static inline bool isLetter(unsigned char c) {
+  return (unsigned char)((c | 0x20) - 'a') <= 'z' - 'a';
+}
+
+static inline bool isDigit(unsigned char c) {
+  return (unsigned char)(c - '0') <= 9;
+}
+
+// classes of the bytes up to the end of the input (the rest of the block is
+// in no class)
+static void classifyScalar(const char* bytes, size_t size,
+                           SimdScanner::Block& block) {
+  block = SimdScanner::Block{0, 0, 0, 0, 0};
+  for (size_t i = 0; i < size; ++i) {
+    unsigned char c = bytes[i];
+    uint64_t bit = 1ULL << i;
+    if (c == ' ' || c == '\t') block.blank |= bit;
+    if (c == '\n') block.newline |= bit;
+    if (isDigit(c)) block.digit |= bit;
+    if (isDigit(c) || isLetter(c)) block.alnum |= bit;
+    if (c == '"' || c == '\\') block.stringStop |= bit;
+  }
+}
+
+#ifdef __x86_64__
+// a class is a byte range [lo, lo + n]: (c - lo) <= n, unsigned
+static void classifySse2(const char* bytes, SimdScanner::Block& block) {
+  block = SimdScanner::Block{0, 0, 0, 0, 0};
+  for (int i = 0; i < 4; ++i) {
+    __m128i x = _mm_loadu_si128((const __m128i*)(bytes + 16 * i));
+    __m128i blank = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8(' ')),
+                                 _mm_cmpeq_epi8(x, _mm_set1_epi8('\t')));
+    __m128i newline = _mm_cmpeq_epi8(x, _mm_set1_epi8('\n'));
+    __m128i d = _mm_sub_epi8(x, _mm_set1_epi8('0'));
+    __m128i digit = _mm_cmpeq_epi8(_mm_min_epu8(d, _mm_set1_epi8(9)), d);
+    __m128i l = _mm_sub_epi8(_mm_or_si128(x, _mm_set1_epi8(0x20)),
+                             _mm_set1_epi8('a'));
+    __m128i letter =
+        _mm_cmpeq_epi8(_mm_min_epu8(l, _mm_set1_epi8('z' - 'a')), l);
+    __m128i stringStop = _mm_or_si128(_mm_cmpeq_epi8(x, _mm_set1_epi8('"')),
+                                      _mm_cmpeq_epi8(x, _mm_set1_epi8('\\')));
+    int shift = 16 * i;
+    block.blank |= (uint64_t)(uint16_t)_mm_movemask_epi8(blank) << shift;
+    block.newline |= (uint64_t)(uint16_t)_mm_movemask_epi8(newline) << shift;
+    block.digit |= (uint64_t)(uint16_t)_mm_movemask_epi8(digit) << shift;
+    block.alnum |= (uint64_t)(uint16_t)_mm_movemask_epi8(
+                       _mm_or_si128(digit, letter))
+                   << shift;
+    block.stringStop |= (uint64_t)(uint16_t)_mm_movemask_epi8(stringStop)
+                        << shift;
+  }
+}
+
+__attribute__((target("avx2"))) static void classifyAvx2(
+    const char* bytes, SimdScanner::Block& block) {
+  block = SimdScanner::Block{0, 0, 0, 0, 0};
+  for (int i = 0; i < 2; ++i) {
+    __m256i x = _mm256_loadu_si256((const __m256i*)(bytes + 32 * i));
+    __m256i blank =
+        _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8(' ')),
+                        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\t')));
+    __m256i newline = _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\n'));
+    __m256i d = _mm256_sub_epi8(x, _mm256_set1_epi8('0'));
+    __m256i digit =
+        _mm256_cmpeq_epi8(_mm256_min_epu8(d, _mm256_set1_epi8(9)), d);
+    __m256i l = _mm256_sub_epi8(_mm256_or_si256(x, _mm256_set1_epi8(0x20)),
+                                _mm256_set1_epi8('a'));
+    __m256i letter =
+        _mm256_cmpeq_epi8(_mm256_min_epu8(l, _mm256_set1_epi8('z' - 'a')), l);
+    __m256i stringStop =
+        _mm256_or_si256(_mm256_cmpeq_epi8(x, _mm256_set1_epi8('"')),
+                        _mm256_cmpeq_epi8(x, _mm256_set1_epi8('\\')));
+    int shift = 32 * i;
+    block.blank |= (uint64_t)(uint32_t)_mm256_movemask_epi8(blank) << shift;
+    block.newline |= (uint64_t)(uint32_t)_mm256_movemask_epi8(newline)
+                     << shift;
+    block.digit |= (uint64_t)(uint32_t)_mm256_movemask_epi8(digit) << shift;
+    block.alnum |= (uint64_t)(uint32_t)_mm256_movemask_epi8(
+                       _mm256_or_si256(digit, letter))
+                   << shift;
+    block.stringStop |= (uint64_t)(uint32_t)_mm256_movemask_epi8(stringStop)
+                        << shift;
+  }
+}
+#else
+static void classifyScalarBlock(const char* bytes, SimdScanner::Block& block) {
+  classifyScalar(bytes, BLOCK_SIZE, block);
+}
+#endif
+
+static SimdScanner::ClassifyFn chooseClassify() {
+#ifdef __x86_64__
+  if (__builtin_cpu_supports("avx2")) return classifyAvx2;
+  return classifySse2;
+#else
+  return classifyScalarBlock;
+#endif
+}
+
+const char* SimdScanner::getInstructionSet() {
+#ifdef __x86_64__
+  ClassifyFn classify = chooseClassify();
+  if (classify == classifyAvx2) return "avx2";
+  if (classify == classifySse2) return "sse2";
+#endif
+  return "scalar";
+}
+
+SimdScanner::SimdScanner(const char* data, size_t size) {
+  static const ClassifyFn classify = chooseClassify();
+  this->data = data;
+  this->size = size;
+  this->pos = 0;
+  this->classify = classify;
+  this->blockStart = SIZE_MAX;
+  this->lineNumber = 1;
+  this->tokenType = "";
+  this->tokenOffset = 0;
+  this->tokenLength = 0;
+}
+
+void SimdScanner::loadBlock(size_t start) {
+  this->blockStart = start;
+  if (start + BLOCK_SIZE <= this->size) {
+    this->classify(this->data + start, this->block);
+  } else {
+    // the last block: no reads past the end of the input
+    classifyScalar(this->data + start, this->size - start, this->block);
+  }
+}
+
+size_t SimdScanner::find(uint64_t Block::*charClass, bool inClass,
+                         size_t from) {
+  while (from < this->size) {
+    size_t start = from & ~(BLOCK_SIZE - 1);
+    if (start != this->blockStart) this->loadBlock(start);
+    uint64_t bits = this->block.*charClass;
+    if (!inClass) bits = ~bits;
+    bits &= ~0ULL << (from - start);
+    if (bits != 0) return min(start + __builtin_ctzll(bits), this->size);
+    from = start + BLOCK_SIZE;
+  }
+  return this->size;
+}
+
+size_t SimdScanner::skipSpace(size_t from) {
+  while (from < this->size) {
+    size_t start = from & ~(BLOCK_SIZE - 1);
+    if (start != this->blockStart) this->loadBlock(start);
+    uint64_t rest = ~0ULL << (from - start);
+    uint64_t stop = ~(this->block.blank | this->block.newline) & rest;
+    // the bits before the first stop
+    uint64_t space = stop != 0 ? (stop & -stop) - 1 : ~0ULL;
+    uint64_t newlines = this->block.newline & rest & space;
+    this->lineNumber += __builtin_popcountll(newlines);
+    if (stop != 0) return min(start + __builtin_ctzll(stop), this->size);
+    from = start + BLOCK_SIZE;
+  }
+  return this->size;
+}
+
+size_t SimdScanner::exponentEnd(size_t from) {
+  const char* data = this->data;
+  if (from >= this->size || (data[from] != 'e' && data[from] != 'E')) {
+    return from;
+  }
+  size_t digits = from + 1;
+  if (digits < this->size && (data[digits] == '+' || data[digits] == '-')) {
+    ++digits;
+  }
+  if (digits >= this->size || !isDigit(data[digits])) return from;
+  return this->find(&Block::digit, false, digits);
+}
+
+int SimdScanner::next() {
+  const char* data = this->data;
+  size_t begin = this->skipSpace(this->pos);
+  if (begin >= this->size) {
+    this->pos = this->size;
+    return 0;
+  }
+  unsigned char c = data[begin];
+  size_t end = begin + 1;
+  int code = ERROR_TOKEN;
+  const char* type = nullptr;
+  if (isLetter(c)) {
+    end = this->find(&Block::alnum, false, begin + 1);
+    code = ID_TOKEN;
+    type = "id";
+    string_view word(data + begin, end - begin);
+    for (const string_view& keyword : KEYWORDS) {
+      if (word == keyword) {
+        code = KEYWORD_TOKEN;
+        type = keyword.data();
+        break;
+      }
+    }
+  } else if (isDigit(c)) {
+    // flex's {float} is {digits}(.{digits})?([eE][-+]?{digits})? with an
+    // unescaped '.': any character but a newline may separate the fraction
+    size_t digitsEnd = this->find(&Block::digit, false, begin + 1);
+    end = this->exponentEnd(digitsEnd);
+    if (digitsEnd + 1 < this->size && data[digitsEnd] != '\n' &&
+        isDigit(data[digitsEnd + 1])) {
+      size_t fractionEnd = this->find(&Block::digit, false, digitsEnd + 2);
+      end = max(end, this->exponentEnd(fractionEnd));
+    }
+    // the longest match, {integer} on a tie
+    if (end == digitsEnd) {
+      code = INT_TOKEN;
+      type = "ic";
+    } else {
+      code = FLOAT_TOKEN;
+      type = "fc";
+    }
+  } else if (c == '"') {
+    // a backslash escapes any character but a newline; unterminated, the
+    // quote is rejected on its own
+    size_t i = begin + 1;
+    while ((i = this->find(&Block::stringStop, true, i)) < this->size) {
+      if (data[i] == '"') {
+        end = i + 1;
+        code = STR_TOKEN;
+        type = "str";
+        break;
+      }
+      if (i + 1 >= this->size || data[i + 1] == '\n') break;
+      i += 2;
+    }
+  } else {
+    switch (c) {
+      case ':':
+        if (begin + 1 < this->size && data[begin + 1] == '=') {
+          end = begin + 2;
+          code = ASSIGN_OP_TOKEN;
+          type = ":=";
+        }
+        break;
+      case '<':
+        code = REL_OP_TOKEN;
+        type = "<";
+        break;
+      case '>':
+        code = REL_OP_TOKEN;
+        type = ">";
+        break;
+      case '=':
+        code = REL_OP_TOKEN;
+        type = "=";
+        break;
+      case '+':
+        code = ARITH_OP_TOKEN;
+        type = "+";
+        break;
+      case '-':
+        code = ARITH_OP_TOKEN;
+        type = "-";
+        break;
+      case '*':
+        code = ARITH_OP_TOKEN;
+        type = "*";
+        break;
+      case '/':
+        code = ARITH_OP_TOKEN;
+        type = "/";
+        break;
+      case '{':
+        code = SEPERATOR_TOKEN;
+        type = "{";
+        break;
+      case '}':
+        code = SEPERATOR_TOKEN;
+        type = "}";
+        break;
+      case '(':
+        code = SEPERATOR_TOKEN;
+        type = "(";
+        break;
+      case ')':
+        code = SEPERATOR_TOKEN;
+        type = ")";
+        break;
+      case ';':
+        code = SEPERATOR_TOKEN;
+        type = ";";
+        break;
+    }
+  }
+  if (type != nullptr) this->tokenType = type;
+  this->tokenOffset = begin;
+  this->tokenLength = end - begin;
+  this->pos = end;
+  return code;
+}
+
+const char* SimdScanner::getTokenType() const { return this->tokenType; }
+
+int SimdScanner::getLineNumber() const { return this->lineNumber; }
+
+size_t SimdScanner::getOffset() const { return this->tokenOffset; }
+
+size_t SimdScanner::getLength() const { return this->tokenLength; }
+
+string_view SimdScanner::getLexeme() const {
+  return string_view(this->data + this->tokenOffset, this->tokenLength);
+}
+
+string SimdScanner::getText() const {
+  string_view lexeme = this->getLexeme();
+  return string(lexeme.substr(0, lexeme.find('\0')));
+}
@@ -0,0 +1,73 @@
+#ifndef __MODULE_2_SIMD_SCANNER_HPP__
+#define __MODULE_2_SIMD_SCANNER_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "lexFns.hpp"
+
+using namespace std;
+
+// A hand-written scanner of lex.l's tokens: same token codes, grammar
+// terminals, lexemes and line numbers as the flex Scanner (see
+// compareScanners.cpp). The input is classified 64 bytes at a time into a
+// bitmask per character class (with AVX2 where the CPU has it, else SSE2), so
+// that runs of blanks, identifier characters, digits and string characters
+// end with a count of trailing zeros, and newlines are counted with popcount.
+// Reads the input in place and never writes to it.
+class SimdScanner {
+ public:
+  // character classes of 64 bytes of input, bit i for byte i
+  struct Block {
+    uint64_t blank;    // ' ', '\t'
+    uint64_t newline;
+    uint64_t alnum;    // [a-zA-Z0-9]
+    uint64_t digit;
+    uint64_t stringStop;  // '"', '\\'
+  };
+  typedef void (*ClassifyFn)(const char* bytes, Block& block);
+
+ private:
+  const char* data;
+  size_t size;
+  size_t pos;
+  ClassifyFn classify;
+  // classes of the 64 bytes at blockStart
+  size_t blockStart;
+  Block block;
+  int lineNumber;
+  const char* tokenType;
+  size_t tokenOffset;
+  size_t tokenLength;
+
+  void loadBlock(size_t start);
+  // first position from `from` on whose byte is (or isn't) in the class
+  size_t find(uint64_t Block::*charClass, bool inClass, size_t from);
+  // first position from `from` on that is neither blank nor a newline,
+  // counting the newlines
+  size_t skipSpace(size_t from);
+  // end of the float's exponent starting at `from` (`from` if there is none)
+  size_t exponentEnd(size_t from);
+
+ public:
+  // scans size bytes of data, which must outlive the scanner
+  SimdScanner(const char* data, size_t size);
+
+  // the next token's code (see lexFns.hpp), ERROR_TOKEN for a character that
+  // starts no token, 0 at the end of the input
+  int next();
+  // grammar terminal of the last token (unchanged by an ERROR_TOKEN)
+  const char* getTokenType() const;
+  int getLineNumber() const;
+  size_t getOffset() const;
+  size_t getLength() const;
+  string_view getLexeme() const;
+  // the lexeme as flex's yytext reads as a C string (a NUL ends it)
+  string getText() const;
+  // instruction set classifying the input: "avx2", "sse2" or "scalar"
+  static const char* getInstructionSet();
+};
+
+#endif
@@ -0,0 +1,174 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+
+#include "MappedFile.hpp"
+#include "Scanner.hpp"
+#include "SimdScanner.hpp"
+
+// Differential check of SimdScanner against the flex Scanner: both scan the
+// given files and random inputs made of lex.l's tokens, edge cases and
+// arbitrary bytes, and every token must agree in code, grammar terminal,
+// span and line number. For the files, the time of both scanners is printed.
+
+static void printUsage(const char* prog) {
+  cout << "Usage: " << prog << " [-n inputs] [-s seed] [files...]\n"
+       << "  -n    number of random inputs (default: 2000)\n"
+       << "  -s    seed of the random inputs (default: 1)\n";
+}
+
+static string randomInput(mt19937& random) {
+  static const vector<string> pieces = {
+      "and", "else", "end", "if", "int", "do", "float", "not", "or",
+      "print", "prog", "scan", "then", "while", "x", "abc1", "intx", "If",
+      "whiles", "9", "123", "1.5", "1e5", "1E-3", "2.5e+7", "1e", "1e+",
+      "1x2", "1 2", "1\t2", "1.", ".5", "12a", "7\"8", "3e5e5", ":=", ":",
+      "=", "<", ">", "+", "-", "*", "/", "\"s\"", "\"a\\\"b\"", "\"\\\\\"",
+      "\"open", "\"multi\nline\"", "\"bad\\\nescape\"", "\"\\", "{", "}",
+      "(", ")", ";", " ", "\t", "\n", "\n\n", "#", "@", "!", "\\", "\r",
+      string(1, '\0'), "1" + string(1, '\0') + "2", "\xff", "\x80" "a"};
+  auto below = [&random](int n) {
+    return uniform_int_distribution<int>(0, n - 1)(random);
+  };
+  string input;
+  int numPieces = below(300);
+  for (int i = 0; i < numPieces; ++i) {
+    if (below(20) == 0) {
+      // arbitrary bytes
+      for (int n = below(8); n > 0; --n) input += (char)below(256);
+    } else {
+      input += pieces[below(pieces.size())];
+    }
+    if (below(2) == 0) input += " \n"[below(2)];
+  }
+  // long runs across blocks
+  if (below(4) == 0) {
+    input += string(1 + below(300), 'a') + " " + string(1 + below(300), '7');
+    input += " \"" + string(below(300), 'z') + "\"" + string(below(300), ' ');
+    input += string(below(200), '\n');
+  }
+  return input;
+}
+
+// "" if both scanners give the same tokens, else the first difference
+static string compare(const char* data, size_t size, Scanner& flexScanner) {
+  SimdScanner simdScanner(data, size);
+  for (int index = 0;; ++index) {
+    int flexCode = flexScanner.next();
+    int simdCode = simdScanner.next();
+    ostringstream difference;
+    difference << "token " << index << " (flex: " << flexCode << " '"
+               << flexScanner.getTokenType() << "' at "
+               << flexScanner.getOffset() << "+" << flexScanner.getLength()
+               << " line " << flexScanner.getLineNumber() << ", simd: "
+               << simdCode << " '" << simdScanner.getTokenType() << "' at "
+               << simdScanner.getOffset() << "+" << simdScanner.getLength()
+               << " line " << simdScanner.getLineNumber() << ")";
+    if (flexCode != simdCode ||
+        flexScanner.getLineNumber() != simdScanner.getLineNumber()) {
+      return difference.str();
+    }
+    if (flexCode == 0) return "";
+    // after an error the terminal is stale (flex's may point at a lexeme
+    // that is no longer NUL-terminated), the parser never reads it
+    if ((flexCode != ERROR_TOKEN &&
+         string(flexScanner.getTokenType()) != simdScanner.getTokenType()) ||
+        flexScanner.getOffset() != simdScanner.getOffset() ||
+        flexScanner.getLength() != simdScanner.getLength() ||
+        flexScanner.getText() != simdScanner.getText()) {
+      return difference.str();
+    }
+  }
+}
+
+static double millisecondsSince(chrono::steady_clock::time_point start) {
+  return chrono::duration<double, milli>(chrono::steady_clock::now() - start)
+      .count();
+}
+
+int main(int argc, char* argv[]) {
+  int numInputs = 2000;
+  unsigned seed = 1;
+  vector<string> paths;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "-n" || arg == "-s") {
+      if (i + 1 >= argc) {
+        printUsage(argv[0]);
+        return EXIT_FAILURE;
+      }
+      string value = argv[++i];
+      if (arg == "-n") {
+        numInputs = stoi(value);
+      } else {
+        seed = stoul(value);
+      }
+    } else if (arg[0] == '-') {
+      printUsage(argv[0]);
+      return EXIT_FAILURE;
+    } else {
+      paths.push_back(arg);
+    }
+  }
+
+  cout << "SimdScanner classifies with " << SimdScanner::getInstructionSet()
+       << "\n";
+  bool failed = false;
+  try {
+    for (const string& path : paths) {
+      // flex NUL-terminates its lexemes in place: a mapping of its own
+      MappedFile flexFile(path), file(path);
+      Scanner flexScanner(flexFile);
+      string difference = compare(file.getData(), file.getSize(), flexScanner);
+      if (!difference.empty()) {
+        cout << path << ": " << difference << "\n";
+        failed = true;
+        continue;
+      }
+      // time of each scanner alone, on a fresh mapping
+      long numTokens = 0;
+      auto start = chrono::steady_clock::now();
+      {
+        MappedFile timedFile(path);
+        Scanner timedScanner(timedFile);
+        while (timedScanner.next()) ++numTokens;
+      }
+      double flexMs = millisecondsSince(start);
+      start = chrono::steady_clock::now();
+      {
+        MappedFile timedFile(path);
+        SimdScanner timedScanner(timedFile.getData(), timedFile.getSize());
+        while (timedScanner.next()) continue;
+      }
+      double simdMs = millisecondsSince(start);
+      double megabytes = file.getSize() / 1e6;
+      cout << fixed << setprecision(1) << path << ": " << numTokens
+           << " tokens, flex " << megabytes / flexMs * 1000 << " MB/s, simd "
+           << megabytes / simdMs * 1000 << " MB/s\n";
+    }
+  } catch (string message) {
+    cout << "Error: " << message << "\n";
+    return EXIT_FAILURE;
+  }
+
+  mt19937 random(seed);
+  for (int i = 0; i < numInputs; ++i) {
+    string input = randomInput(random);
+    Scanner flexScanner(input);
+    string difference = compare(input.data(), input.size(), flexScanner);
+    if (!difference.empty()) {
+      cout << "random input " << i << " (seed " << seed << "): " << difference
+           << "\n";
+      failed = true;
+      break;
+    }
+  }
+  if (!failed) {
+    cout << "Same tokens on " << paths.size() << " file(s) and " << numInputs
+         << " random inputs\n";
+  }
+  return failed ? EXIT_FAILURE : 0;
+}
@@ -1,10 +1,51 @@
-#ifndef __lexFns_HPP__
-#define __lexFns_HPP__
-// extern "C" -> we want to use following fns/variables from a C code compiled using gcc (not g++)
-extern "C" {
-	int yylex(void);
-	extern char* yytext;
-	extern int line_number;
-	extern char* yy_token_type;
-}
-#endif
\ No newline at end of file
+#ifndef __lexFns_HPP__
+#define __lexFns_HPP__
+// the reentrant scanner generated from lex.l, shared by lex.yy.c (C compiled
+// using gcc, not g++) and Scanner.cpp
+#include <stddef.h>
+#include <stdio.h>
+
+#define KEYWORD_TOKEN 1
+#define STR_TOKEN 1
+#define INT_TOKEN 3
+#define ID_TOKEN 5
+#define FLOAT_TOKEN 4
+#define REL_OP_TOKEN 6
+#define ARITH_OP_TOKEN 7
+#define ASSIGN_OP_TOKEN 8
+#define SEPERATOR_TOKEN 9
+#define ERROR_TOKEN -1
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// per-scanner state (yyextra) set by the rules of lex.l
+struct ScannerState {
+  int lineNumber;
+  // grammar terminal of the last token, valid until the next yylex call
+  const char* tokenType;
+  // span of the last match in the input, in bytes from its beginning
+  size_t tokenOffset;
+  size_t tokenLength;
+};
+
+#ifndef YY_TYPEDEF_YY_SCANNER_T
+#define YY_TYPEDEF_YY_SCANNER_T
+typedef void* yyscan_t;
+#endif
+
+int yylex_init_extra(struct ScannerState* state, yyscan_t* scanner);
+int yylex(yyscan_t scanner);
+int yylex_destroy(yyscan_t scanner);
+char* yyget_text(yyscan_t scanner);
+void yyset_in(FILE* input, yyscan_t scanner);
+struct yy_buffer_state* yy_scan_bytes(const char* bytes, int length,
+                                      yyscan_t scanner);
+struct yy_buffer_state* yy_scan_buffer(char* base, size_t size,
+                                       yyscan_t scanner);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
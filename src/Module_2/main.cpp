@@ -1,30 +1,91 @@
-#include "LL1Parser.hpp"
-#include "lexFns.hpp"
+#include <iterator>
+
+#include "../Common/ParserRegistry.hpp"
+#include "Scanner.hpp"
+#include "SimdScanner.hpp"
+
+// prints the tokens and the rejected characters of the test-input as they
+// are scanned, returns the tokens' grammar terminals
+template <class ScannerType>
+static vector<string> scanTokens(ScannerType& scanner) {
+  vector<string> tokens;
+  int token = scanner.next();
+  while (token) {
+    if (token == ERROR_TOKEN) {
+      cout << "Error in line " << scanner.getLineNumber()
+           << ", Rejecting: " << scanner.getText() << "\n";
+    } else {
+      cout << "Token: " << scanner.getTokenType() << "\n";
+      tokens.push_back(scanner.getTokenType());
+    }
+    token = scanner.next();
+  }
+  return tokens;
+}
+
+int main(int argc, char* argv[]) {
+  // the test-input follows on stdin, or is the file given as an argument
+  // (mapped and scanned in place); -s scans it with SimdScanner instead of
+  // the flex scanner
+  bool useSimdScanner = false;
+  string inputPath;
+  for (int i = 1; i < argc; ++i) {
+    string arg = argv[i];
+    if (arg == "-s") {
+      useSimdScanner = true;
+    } else {
+      inputPath = arg;
+    }
+  }
 
-int main() {
   string dirPath;
   cout << "Enter a (relative/absolute) path of a directory where the grammar's "
           "files should be saved:\n";
   cin >> dirPath;
 
-  LL1Parser ll1(dirPath);
+  // a grammar plugin (see GrammarPlugin.hpp) can be given instead of the
+  // directory of the grammar's files
+  ParserRegistry registry;
+  bool isPlugin = dirPath.size() > 3 &&
+                  dirPath.compare(dirPath.size() - 3, 3, ".so") == 0;
+  try {
+    if (isPlugin) {
+      registry.loadPlugin(dirPath, dirPath);
+    } else {
+      registry.add(dirPath, unique_ptr<LL1Parser>(new LL1Parser(dirPath)));
+    }
+  } catch (string message) {
+    cout << "Error: " << message << "\n";
+    return EXIT_FAILURE;
+  }
   vector<string> tokens;
-
-  cout << "Test-input:\n";
-  int token = yylex();
-  while (token) {
-    if (token == -1) {
-      cout << "Error in line " << line_number << ", Rejecting: " << yytext
-           << "\n";
+  try {
+    unique_ptr<MappedFile> inputFile;
+    if (!inputPath.empty()) inputFile.reset(new MappedFile(inputPath));
+    if (useSimdScanner) {
+      // SimdScanner reads its input from memory
+      string input;
+      if (inputFile == nullptr) {
+        input.assign(istreambuf_iterator<char>(cin),
+                     istreambuf_iterator<char>());
+      }
+      SimdScanner scanner(inputFile ? inputFile->getData() : input.data(),
+                          inputFile ? inputFile->getSize() : input.size());
+      cout << "Test-input:\n";
+      tokens = scanTokens(scanner);
     } else {
-      cout << "Token: " << yy_token_type << "\n";
-      tokens.push_back(yy_token_type);
+      unique_ptr<Scanner> scanner(inputFile ? new Scanner(*inputFile)
+                                            : new Scanner(stdin));
+      cout << "Test-input:\n";
+      tokens = scanTokens(*scanner);
     }
-    token = yylex();
+  } catch (string message) {
+    cout << "Error: " << message << "\n";
+    return EXIT_FAILURE;
   }
   tokens.push_back(DOLLAR_SYMBOL);
 
-  bool isValid = ll1.predictiveParsing(tokens);
+  bool isValid = registry.predictiveParsing(dirPath, tokens);
   cout << "Verdict: " << (isValid ? "Accepted" : "Rejected") << "\n";
   return 0;
 }
@@ -0,0 +1,429 @@
+#ifndef __STATIC_LL1_HPP__
+#define __STATIC_LL1_HPP__
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <initializer_list>
+#include <span>
+#include <string_view>
+#include <vector>
+
+using namespace std;
+
+// LL(1) parsers for grammars fixed at build time (C++20, header only).
+//
+// The grammar is written as constexpr data, in the rule format of
+// Grammar.txt:
+//
+//    static constexpr auto expr = StaticLL1::grammar(
+//        "E", "E -> [ T E_' ]", "E_' -> [ + T E_' | ε ]", ...);
+//    using ExprParser = StaticLL1::Parser<expr>;
+//
+// The first argument is the start symbol. Every other symbol on a rhs which
+// has no rules of its own is a terminal. FIRST, FOLLOW and the parsing table
+// are computed by the compiler with the same algorithms as LL1.cpp, and the
+// parser only reads the resulting constant tables: nothing is set up at run
+// time. Unlike Module_1 nothing is rewritten, so the grammar must already be
+// LL(1) (see LL1Grammar.txt of a compiled grammar): a malformed grammar or an
+// LL(1) conflict is a compile error naming the problem.
+namespace StaticLL1 {
+
+template <size_t N>
+struct Grammar {
+  string_view startSymbol;
+  array<string_view, N> rules;
+};
+
+template <typename... Rules>
+constexpr Grammar<sizeof...(Rules)> grammar(string_view startSymbol,
+                                            Rules... rules) {
+  return {startSymbol, {string_view(rules)...}};
+}
+
+namespace detail {
+
+// Not constexpr, and never defined: a grammar calling it does not compile,
+// and the error shows the message.
+void grammarError(const char* message);
+
+// Cell of the parsing table claimed by two rules (nonTer < 0 -> none)
+struct Conflict {
+  int nonTer = -1;
+  int terminal = -1;
+  int firstRule = -1;
+  int secondRule = -1;
+};
+
+// The grammar as read, with its sets and table. Symbols by id: terminals
+// first ($ is the last of them), then the non-terminals in the order of
+// their rules.
+struct Analysis {
+  vector<string_view> names;
+  int numTerminals = 0;
+  int start = -1;
+  vector<int> ruleLhs;
+  vector<vector<int>> ruleRhs;
+  // first[nonTer * numTerminals + terminal], follow likewise; indexed by
+  // id - numTerminals for non-terminals
+  vector<char> first;
+  vector<char> nullable;
+  vector<char> follow;
+  vector<int> table;
+  Conflict conflict;
+};
+
+constexpr vector<string_view> splitTokens(string_view text) {
+  vector<string_view> tokens;
+  size_t i = 0;
+  while (i < text.size()) {
+    if (text[i] == ' ' || text[i] == '\t' || text[i] == '\n') {
+      ++i;
+      continue;
+    }
+    size_t end = i;
+    while (end < text.size() && text[end] != ' ' && text[end] != '\t' &&
+           text[end] != '\n') {
+      ++end;
+    }
+    tokens.push_back(text.substr(i, end - i));
+    i = end;
+  }
+  return tokens;
+}
+
+constexpr int idOf(const vector<string_view>& names, string_view name) {
+  auto it = find(names.begin(), names.end(), name);
+  return (it != names.end()) ? it - names.begin() : -1;
+}
+
+template <size_t N>
+constexpr void readRules(const Grammar<N>& grammar, Analysis& analysis) {
+  vector<vector<string_view>> lines;
+  vector<string_view> nonTers;
+  for (string_view rule : grammar.rules) {
+    vector<string_view> tokens = splitTokens(rule);
+    if (tokens.size() < 4 || tokens[1] != "->" || tokens[2] != "[" ||
+        tokens.back() != "]") {
+      grammarError("a rule must look like \"A -> [ a B | ε ]\"");
+    }
+    if (idOf(nonTers, tokens[0]) >= 0) {
+      grammarError("all the rules of a non-terminal go on one line");
+    }
+    nonTers.push_back(tokens[0]);
+    lines.push_back(tokens);
+  }
+
+  vector<string_view> terminals;
+  for (const vector<string_view>& tokens : lines) {
+    for (size_t k = 3; k + 1 < tokens.size(); ++k) {
+      string_view token = tokens[k];
+      if (token == "[" || token == "]" || token == "->" || token == "$" ||
+          (token.size() == 2 && (token[0] == '[' || token[0] == ']'))) {
+        grammarError("EBNF groups and reserved symbols can't be used");
+      }
+      if (token == "|" || token == "ε") continue;
+      if (idOf(nonTers, token) < 0 && idOf(terminals, token) < 0) {
+        terminals.push_back(token);
+      }
+    }
+  }
+  analysis.names = terminals;
+  analysis.names.push_back("$");
+  analysis.numTerminals = analysis.names.size();
+  for (string_view nonTer : nonTers) analysis.names.push_back(nonTer);
+  analysis.start = idOf(nonTers, grammar.startSymbol);
+  if (analysis.start < 0) grammarError("the start symbol has no rules");
+  analysis.start += analysis.numTerminals;
+
+  for (const vector<string_view>& tokens : lines) {
+    int lhs = idOf(analysis.names, tokens[0]);
+    vector<int> rhs;
+    bool isEmpty = true;
+    for (size_t k = 3; k < tokens.size(); ++k) {
+      if (tokens[k] == "|" || tokens[k] == "]") {
+        if (isEmpty) grammarError("empty alternative (write ε)");
+        analysis.ruleLhs.push_back(lhs);
+        analysis.ruleRhs.push_back(rhs);
+        rhs.clear();
+        isEmpty = true;
+      } else {
+        isEmpty = false;
+        if (tokens[k] != "ε") rhs.push_back(idOf(analysis.names, tokens[k]));
+      }
+    }
+  }
+}
+
+// adds first(rhs[from..]) (without ε) to first[row], returns true if that
+// part of rhs derives ε
+constexpr bool addFirstOf(Analysis& analysis, const vector<int>& rhs,
+                          size_t from, vector<char>& sets, int row) {
+  int numTerminals = analysis.numTerminals;
+  for (size_t k = from; k < rhs.size(); ++k) {
+    int sym = rhs[k];
+    if (sym < numTerminals) {
+      sets[row * numTerminals + sym] = 1;
+      return false;
+    }
+    int symRow = sym - numTerminals;
+    for (int t = 0; t < numTerminals; ++t) {
+      if (analysis.first[symRow * numTerminals + t]) {
+        sets[row * numTerminals + t] = 1;
+      }
+    }
+    if (!analysis.nullable[symRow]) return false;
+  }
+  return true;
+}
+
+constexpr void computeFirst(Analysis& analysis) {
+  int numTerminals = analysis.numTerminals;
+  int numNonTers = analysis.names.size() - numTerminals;
+  analysis.first.assign(numNonTers * numTerminals, 0);
+  analysis.nullable.assign(numNonTers, 0);
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (size_t r = 0; r < analysis.ruleLhs.size(); ++r) {
+      int row = analysis.ruleLhs[r] - numTerminals;
+      vector<char> before(analysis.first.begin() + row * numTerminals,
+                          analysis.first.begin() + (row + 1) * numTerminals);
+      bool derivesEps =
+          addFirstOf(analysis, analysis.ruleRhs[r], 0, analysis.first, row);
+      if (derivesEps && !analysis.nullable[row]) {
+        analysis.nullable[row] = 1;
+        changed = true;
+      }
+      changed |= !equal(before.begin(), before.end(),
+                        analysis.first.begin() + row * numTerminals);
+    }
+  }
+}
+
+constexpr void computeFollow(Analysis& analysis) {
+  int numTerminals = analysis.numTerminals;
+  int numNonTers = analysis.names.size() - numTerminals;
+  analysis.follow.assign(numNonTers * numTerminals, 0);
+  analysis.follow[(analysis.start - numTerminals) * numTerminals +
+                  numTerminals - 1] = 1;
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (size_t r = 0; r < analysis.ruleLhs.size(); ++r) {
+      const vector<int>& rhs = analysis.ruleRhs[r];
+      int lhsRow = analysis.ruleLhs[r] - numTerminals;
+      for (size_t k = 0; k < rhs.size(); ++k) {
+        if (rhs[k] < numTerminals) continue;
+        int row = rhs[k] - numTerminals;
+        vector<char> before(analysis.follow.begin() + row * numTerminals,
+                            analysis.follow.begin() + (row + 1) * numTerminals);
+        if (addFirstOf(analysis, rhs, k + 1, analysis.follow, row)) {
+          for (int t = 0; t < numTerminals; ++t) {
+            if (analysis.follow[lhsRow * numTerminals + t]) {
+              analysis.follow[row * numTerminals + t] = 1;
+            }
+          }
+        }
+        changed |= !equal(before.begin(), before.end(),
+                          analysis.follow.begin() + row * numTerminals);
+      }
+    }
+  }
+}
+
+constexpr void buildParsingTable(Analysis& analysis) {
+  int numTerminals = analysis.numTerminals;
+  int numNonTers = analysis.names.size() - numTerminals;
+  analysis.table.assign(numNonTers * numTerminals, -1);
+  for (size_t r = 0; r < analysis.ruleLhs.size(); ++r) {
+    int row = analysis.ruleLhs[r] - numTerminals;
+    // predict set: first(rhs), plus follow(lhs) if rhs derives ε
+    vector<char> predict(numTerminals, 0);
+    if (addFirstOf(analysis, analysis.ruleRhs[r], 0, predict, 0)) {
+      for (int t = 0; t < numTerminals; ++t) {
+        predict[t] |= analysis.follow[row * numTerminals + t];
+      }
+    }
+    for (int t = 0; t < numTerminals; ++t) {
+      if (!predict[t]) continue;
+      int& cell = analysis.table[row * numTerminals + t];
+      if (cell >= 0 && analysis.conflict.nonTer < 0) {
+        analysis.conflict = {row + numTerminals, t, cell, (int)r};
+      }
+      if (cell < 0) cell = r;
+    }
+  }
+}
+
+template <size_t N>
+constexpr Analysis analyze(const Grammar<N>& grammar) {
+  Analysis analysis;
+  readRules(grammar, analysis);
+  computeFirst(analysis);
+  computeFollow(analysis);
+  buildParsingTable(analysis);
+  return analysis;
+}
+
+struct Sizes {
+  size_t numSymbols;
+  size_t numTerminals;
+  size_t numRules;
+  size_t numRhsSyms;
+};
+
+template <size_t N>
+constexpr Sizes sizesOf(const Grammar<N>& grammar) {
+  Analysis analysis = analyze(grammar);
+  size_t numRhsSyms = 0;
+  for (const vector<int>& rhs : analysis.ruleRhs) numRhsSyms += rhs.size();
+  return {analysis.names.size(), (size_t)analysis.numTerminals,
+          analysis.ruleLhs.size(), numRhsSyms};
+}
+
+// The analysis in arrays, so that it can be kept as a constant
+template <Sizes S>
+struct Tables {
+  array<string_view, S.numSymbols> names;
+  // terminal ids sorted by name
+  array<int, S.numTerminals> terminalsByName;
+  int start;
+  array<int, S.numRules> ruleLhs;
+  // rhs of rule r: rhs[ruleBegin[r], ruleBegin[r + 1])
+  array<int, S.numRules + 1> ruleBegin;
+  array<int, S.numRhsSyms> rhs;
+  // rule at table[(nonTer - numTerminals) * numTerminals + terminal]
+  // (-1 -> empty cell)
+  array<int, (S.numSymbols - S.numTerminals) * S.numTerminals> table;
+  Conflict conflict;
+};
+
+template <Sizes S, size_t N>
+constexpr Tables<S> buildTables(const Grammar<N>& grammar) {
+  Analysis analysis = analyze(grammar);
+  Tables<S> tables{};
+  copy(analysis.names.begin(), analysis.names.end(), tables.names.begin());
+  for (size_t t = 0; t < S.numTerminals; ++t) tables.terminalsByName[t] = t;
+  sort(tables.terminalsByName.begin(), tables.terminalsByName.end(),
+       [&](int a, int b) { return analysis.names[a] < analysis.names[b]; });
+  tables.start = analysis.start;
+  int numRhsSyms = 0;
+  for (size_t r = 0; r < S.numRules; ++r) {
+    tables.ruleLhs[r] = analysis.ruleLhs[r];
+    tables.ruleBegin[r] = numRhsSyms;
+    for (int sym : analysis.ruleRhs[r]) tables.rhs[numRhsSyms++] = sym;
+  }
+  tables.ruleBegin[S.numRules] = numRhsSyms;
+  copy(analysis.table.begin(), analysis.table.end(), tables.table.begin());
+  tables.conflict = analysis.conflict;
+  return tables;
+}
+
+// A name usable as a template argument, so that it shows up in errors
+template <size_t N>
+struct FixedName {
+  char chars[N + 1] = {};
+  constexpr FixedName(string_view name) {
+    for (size_t i = 0; i < N; ++i) this->chars[i] = name[i];
+  }
+};
+
+// Instantiated with the cell of the first conflict of the table (empty names
+// if there is none)
+template <FixedName NonTer, FixedName Terminal, int FirstRule, int SecondRule>
+struct CheckLL1 {
+  static_assert(sizeof(NonTer.chars) == 1,
+                "not LL(1): two rules of NonTer (FirstRule and SecondRule, "
+                "counting from 0) both predict Terminal");
+  static constexpr bool value = true;
+};
+
+}  // namespace detail
+
+template <const auto& G>
+class Parser {
+  static constexpr detail::Sizes sizes = detail::sizesOf(G);
+  static constexpr detail::Tables<sizes> tables =
+      detail::buildTables<sizes>(G);
+  static constexpr detail::Conflict conflict = tables.conflict;
+  static constexpr string_view conflictNonTer =
+      (conflict.nonTer >= 0) ? tables.names[conflict.nonTer] : "";
+  static constexpr string_view conflictTerminal =
+      (conflict.nonTer >= 0) ? tables.names[conflict.terminal] : "";
+  static_assert(
+      detail::CheckLL1<detail::FixedName<conflictNonTer.size()>(
+                           conflictNonTer),
+                       detail::FixedName<conflictTerminal.size()>(
+                           conflictTerminal),
+                       conflict.firstRule, conflict.secondRule>::value);
+
+ public:
+  static constexpr int numTerminals = sizes.numTerminals;
+  static constexpr int numSymbols = sizes.numSymbols;
+  static constexpr int numRules = sizes.numRules;
+  // id of the end of input ($)
+  static constexpr int dollar = numTerminals - 1;
+
+  // id of a terminal, -1 if there is none with that name
+  static constexpr int terminal(string_view name) {
+    auto it = lower_bound(
+        tables.terminalsByName.begin(), tables.terminalsByName.end(), name,
+        [](int sym, string_view key) { return tables.names[sym] < key; });
+    if (it == tables.terminalsByName.end() || tables.names[*it] != name) {
+      return -1;
+    }
+    return *it;
+  }
+  static constexpr string_view name(int sym) { return tables.names[sym]; }
+  static constexpr bool isTerminal(int sym) { return sym < numTerminals; }
+  static constexpr int lhs(int rule) { return tables.ruleLhs[rule]; }
+  // empty for an ε rule
+  static constexpr span<const int> rhs(int rule) {
+    return span<const int>(tables.rhs.data() + tables.ruleBegin[rule],
+                           tables.ruleBegin[rule + 1] - tables.ruleBegin[rule]);
+  }
+  // rule for nonTer when terminal is next, -1 if there is none
+  static constexpr int predict(int nonTer, int terminal) {
+    return tables.table[(nonTer - numTerminals) * numTerminals + terminal];
+  }
+
+  // parses terminal ids (without the final $), calling onRule(rule) for
+  // every rule applied, in the order of the leftmost derivation
+  template <typename OnRule>
+  static constexpr bool parse(span<const int> tokens, OnRule&& onRule) {
+    vector<int> stack{dollar, tables.start};
+    size_t next = 0;
+    while (!stack.empty()) {
+      int top = stack.back();
+      int token = (next < tokens.size()) ? tokens[next] : dollar;
+      if (token < 0 || token >= numTerminals) return false;
+      if (isTerminal(top)) {
+        if (top != token) return false;
+        stack.pop_back();
+        if (top == dollar) return next == tokens.size();
+        ++next;
+        continue;
+      }
+      int rule = predict(top, token);
+      if (rule < 0) return false;
+      onRule(rule);
+      stack.pop_back();
+      span<const int> ruleRhs = rhs(rule);
+      for (auto it = ruleRhs.rbegin(); it != ruleRhs.rend(); ++it) {
+        stack.push_back(*it);
+      }
+    }
+    return false;
+  }
+  static constexpr bool parse(span<const int> tokens) {
+    return parse(tokens, [](int) {});
+  }
+  static constexpr bool accepts(initializer_list<string_view> names) {
+    vector<int> tokens;
+    for (string_view tokenName : names) tokens.push_back(terminal(tokenName));
+    return parse(tokens);
+  }
+};
+
+}  // namespace StaticLL1
+
+#endif
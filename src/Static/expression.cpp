@@ -0,0 +1,47 @@
+#include <iostream>
+#include <string>
+
+#include "StaticLL1.hpp"
+
+// grammar_1 (E -> E + T | T, ...) once its left recursion is gone, parsed
+// without reading any generated file
+
+static constexpr auto expression = StaticLL1::grammar(
+    "E",
+    "E -> [ T E_' ]",
+    "T -> [ F T_' ]",
+    "F -> [ ( E ) | id ]",
+    "E_' -> [ + T E_' | ε ]",
+    "T_' -> [ * F T_' | ε ]");
+using ExpressionParser = StaticLL1::Parser<expression>;
+
+static_assert(ExpressionParser::accepts({"id", "+", "id", "*", "id"}));
+static_assert(ExpressionParser::accepts({"(", "id", "+", "id", ")"}));
+static_assert(!ExpressionParser::accepts({"id", "+"}));
+static_assert(!ExpressionParser::accepts({"id", "id"}));
+
+int main() {
+  // tokens separated by white space, as in grammar_1/Grammar.txt
+  vector<int> tokens;
+  for (string token; cin >> token;) {
+    int terminal = ExpressionParser::terminal(token);
+    if (terminal < 0) {
+      cout << "Unexpected symbol: " << token << "\n";
+      cout << "Verdict: Rejected\n";
+      return EXIT_FAILURE;
+    }
+    tokens.push_back(terminal);
+  }
+
+  bool isValid = ExpressionParser::parse(tokens, [](int rule) {
+    cout << "Applying production rule: "
+         << ExpressionParser::name(ExpressionParser::lhs(rule)) << " -> [ ";
+    for (int sym : ExpressionParser::rhs(rule)) {
+      cout << ExpressionParser::name(sym) << " ";
+    }
+    if (ExpressionParser::rhs(rule).empty()) cout << "ε ";
+    cout << "]\n";
+  });
+  cout << "Verdict: " << (isValid ? "Accepted" : "Rejected") << "\n";
+  return isValid ? 0 : EXIT_FAILURE;
+}